@@ -0,0 +1,221 @@
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <string_view>
+#include <tuple>
+#include <vector>
+
+#include <sys/resource.h>
+
+#include "associated_collection.hpp"
+#include "counting_new.hpp"
+
+// Scaling benchmark for associated_collection.
+//
+// Builds two mirrored collections over a synthetic many-to-many graph for each size
+// from --min to --max (powers of ten), then times a sample of each operation against them.
+// Every element gets --fanout associations whose foreign keys are drawn with a power law
+// of exponent --skew in [0, 1), 0 being uniform. An operation stops after --ops calls or
+// --budget seconds, whichever comes first, so quadratic paths show as a cliff in ns/op.
+//
+// usage: associated_collection_bench [--min=1000] [--max=1000000] [--fanout=4] [--skew=0.5]
+//                                    [--ops=1000] [--budget=0.5] [--seed=1]
+
+namespace {
+
+	using counting_new::allocations;
+	using counting_new::allocated_bytes;
+
+	using left_key  = std::tuple<int, float>;
+	using right_key = std::tuple<int, int>;
+
+	struct left {
+		left_key key;
+		bool operator==(left_key const& k) const { return key == k; }
+		bool operator==(left const& e)     const { return key == e.key; }
+		bool operator<(left_key const& k)  const { return key < k; }
+		bool operator<(left const& e)      const { return key < e.key; }
+	};
+
+	struct right {
+		right_key key;
+		bool operator==(right_key const& k) const { return key == k; }
+		bool operator==(right const& e)     const { return key == e.key; }
+		bool operator<(right_key const& k)  const { return key < k; }
+		bool operator<(right const& e)      const { return key < e.key; }
+	};
+
+	using left_collection  = associated_collection<left, right_key>;
+	using right_collection = associated_collection<right, left_key>;
+
+	struct options {
+		std::size_t min_size{ 1000 };
+		std::size_t max_size{ 1000000 };
+		std::size_t fanout{ 4 };
+		double      skew{ 0.5 };
+		std::size_t ops{ 1000 };
+		double      budget{ 0.5 };
+		unsigned    seed{ 1 };
+	};
+
+	auto parse(int argc, char** argv) -> options {
+		options o;
+		for (int i = 1; i < argc; ++i) {
+			const std::string_view arg{ argv[i] };
+			const auto value = [&](std::string_view name) -> char const* {
+				return arg.starts_with(name) ? argv[i] + name.size() : nullptr;
+			};
+
+			if      (auto v = value("--min="))    o.min_size = std::strtoull(v, nullptr, 10);
+			else if (auto v = value("--max="))    o.max_size = std::strtoull(v, nullptr, 10);
+			else if (auto v = value("--fanout=")) o.fanout   = std::strtoull(v, nullptr, 10);
+			else if (auto v = value("--skew="))   o.skew     = std::clamp(std::strtod(v, nullptr), 0.0, 0.99);
+			else if (auto v = value("--ops="))    o.ops      = std::strtoull(v, nullptr, 10);
+			else if (auto v = value("--budget=")) o.budget   = std::strtod(v, nullptr);
+			else if (auto v = value("--seed="))   o.seed     = static_cast<unsigned>(std::strtoul(v, nullptr, 10));
+			else std::fprintf(stderr, "ignoring unknown argument %s\n", argv[i]);
+		}
+		return o;
+	}
+
+	auto peak_rss_mb() -> double {
+		rusage usage{};
+		getrusage(RUSAGE_SELF, &usage);
+		return static_cast<double>(usage.ru_maxrss) / 1024.0;
+	}
+
+	auto make_left(std::size_t i)  -> left_key  { return { static_cast<int>(i), 0.f }; }
+	auto make_right(std::size_t i) -> right_key { return { static_cast<int>(i), 0 }; }
+
+	// Power law over [0, size): pdf proportional to x^-skew.
+	auto skewed(std::mt19937_64& rng, std::size_t size, double skew) -> std::size_t {
+		const double u = std::uniform_real_distribution<double>{ 0.0, 1.0 }(rng);
+		return std::min(size - 1, static_cast<std::size_t>(static_cast<double>(size) * std::pow(u, 1.0 / (1.0 - skew))));
+	}
+
+	struct measurement {
+		std::size_t ops{ 0 };
+		double      seconds{ 0 };
+		std::size_t allocations{ 0 };
+		std::size_t bytes{ 0 };
+	};
+
+	// Runs operation(i) until max_ops calls or budget seconds are spent.
+	template<class Operation>
+	auto measure(std::size_t max_ops, double budget, Operation operation) -> measurement {
+		using clock = std::chrono::steady_clock;
+		const auto allocations_before = allocations.load();
+		const auto bytes_before       = allocated_bytes.load();
+		const auto start              = clock::now();
+
+		measurement m;
+		while (m.ops < max_ops) {
+			operation(m.ops++);
+			m.seconds = std::chrono::duration<double>(clock::now() - start).count();
+			if (m.seconds > budget) {
+				break;
+			}
+		}
+
+		m.allocations = allocations.load() - allocations_before;
+		m.bytes       = allocated_bytes.load() - bytes_before;
+		return m;
+	}
+
+	void report(std::size_t size, char const* name, measurement const& m) {
+		const double ops = static_cast<double>(std::max<std::size_t>(m.ops, 1));
+		std::printf("%10zu  %-22s %8zu %14.1f %12.2f %14.1f %10.1f\n", size, name, m.ops,
+		            m.seconds * 1e9 / ops, static_cast<double>(m.allocations) / ops,
+		            static_cast<double>(m.bytes) / ops, peak_rss_mb());
+		std::fflush(stdout);
+	}
+
+	void run(options const& o, std::size_t size) {
+		std::mt19937_64 rng{ o.seed + size };
+
+		std::vector<left>  lefts;
+		std::vector<right> rights;
+		std::vector<std::pair<left_key, right_key>> left_associations;
+		std::vector<std::pair<right_key, left_key>> right_associations;
+		lefts.reserve(size);
+		rights.reserve(size);
+		left_associations.reserve(size * o.fanout);
+		right_associations.reserve(size * o.fanout);
+
+		for (std::size_t i = 0; i != size; ++i) {
+			lefts.push_back(left{ make_left(i) });
+			rights.push_back(right{ make_right(i) });
+			for (std::size_t f = 0; f != o.fanout; ++f) {
+				const auto j = skewed(rng, size, o.skew);
+				left_associations.emplace_back(make_left(i), make_right(j));
+				right_associations.emplace_back(make_right(j), make_left(i));
+			}
+		}
+
+		left_collection  lc;
+		right_collection rc;
+		report(size, "bulk build", measure(1, 0.0, [&](std::size_t) {
+			lc.insert(std::begin(lefts), std::end(lefts));
+			lc.insert_associations(std::begin(left_associations), std::end(left_associations));
+			rc.insert(std::begin(rights), std::end(rights));
+			rc.insert_associations(std::begin(right_associations), std::end(right_associations));
+		}));
+
+		const auto any_left  = [&] { return make_left(std::uniform_int_distribution<std::size_t>{ 0, size - 1 }(rng)); };
+		const auto any_right = [&] { return make_right(skewed(rng, size, o.skew)); };
+
+		report(size, "emplace", measure(o.ops, o.budget, [&](std::size_t i) {
+			lc.emplace(left{ make_left(size + i) });
+		}));
+
+		report(size, "emplace_association", measure(o.ops, o.budget, [&](std::size_t i) {
+			emplace_associations(lc, rc, make_left(size + i), any_right());
+		}));
+
+		std::size_t visited = 0;
+		report(size, "visit", measure(o.ops, o.budget, [&](std::size_t) {
+			lc.visit(any_right(), [&](auto&) { ++visited; });
+		}));
+
+		std::size_t equal = 0;
+		report(size, "compare_associations", measure(o.ops, o.budget, [&](std::size_t) {
+			equal += lc.compare_associations(any_left(), any_left());
+		}));
+
+		left_collection::foreign_collection_type erased;
+		report(size, "erase(key)", measure(o.ops, o.budget, [&](std::size_t) {
+			erased.clear();
+			lc.erase(any_left(), erased);
+		}));
+
+		// Runs last, erase(inverse_foreign_type) also erases the elements left with the associations of another.
+		right_collection::foreign_collection_type cascade;
+		left_collection::foreign_collection_type  cascaded;
+		report(size, "cascade erase", measure(o.ops, o.budget, [&](std::size_t) {
+			cascade.clear();
+			cascaded.clear();
+			rc.erase(any_right(), cascade);
+			lc.erase(cascade, cascaded);
+		}));
+
+		if (visited + equal == 0) {
+			std::printf("%10zu  (no associations were visited)\n", size);
+		}
+	}
+}
+
+auto main(int argc, char** argv) -> int
+{
+	const auto o = parse(argc, argv);
+	std::printf("fanout %zu, skew %.2f, at most %zu ops or %.2fs per operation\n\n", o.fanout, o.skew, o.ops, o.budget);
+	std::printf("%10s  %-22s %8s %14s %12s %14s %10s\n", "elements", "operation", "ops", "ns/op", "allocs/op", "bytes/op", "peak MB");
+
+	for (std::size_t size = o.min_size; size <= o.max_size and size != 0; size *= 10) {
+		run(o, size);
+	}
+	return 0;
+}
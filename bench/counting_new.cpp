@@ -0,0 +1,65 @@
+#include <cstdlib>
+#include <new>
+
+#include "counting_new.hpp"
+
+namespace counting_new {
+
+	std::atomic<std::size_t> allocations{ 0 };
+	std::atomic<std::size_t> allocated_bytes{ 0 };
+
+	namespace {
+
+		auto allocate(std::size_t size, std::size_t alignment) -> void* {
+			allocations.fetch_add(1, std::memory_order_relaxed);
+			allocated_bytes.fetch_add(size, std::memory_order_relaxed);
+
+			if (size == 0) {
+				size = 1;
+			}
+			void* p = nullptr;
+			if (alignment <= __STDCPP_DEFAULT_NEW_ALIGNMENT__) {
+				p = std::malloc(size);
+			}
+			else {
+				// aligned_alloc wants a size that is a multiple of the alignment.
+				p = std::aligned_alloc(alignment, (size + alignment - 1) / alignment * alignment);
+			}
+			if (p == nullptr) {
+				throw std::bad_alloc{};
+			}
+			return p;
+		}
+
+		auto allocate(std::size_t size, std::size_t alignment, std::nothrow_t const&) noexcept -> void* {
+			try {
+				return allocate(size, alignment);
+			}
+			catch (std::bad_alloc const&) {
+				return nullptr;
+			}
+		}
+	}
+}
+
+void* operator new(std::size_t size)                                                     { return counting_new::allocate(size, __STDCPP_DEFAULT_NEW_ALIGNMENT__); }
+void* operator new[](std::size_t size)                                                   { return counting_new::allocate(size, __STDCPP_DEFAULT_NEW_ALIGNMENT__); }
+void* operator new(std::size_t size, std::align_val_t alignment)                         { return counting_new::allocate(size, static_cast<std::size_t>(alignment)); }
+void* operator new[](std::size_t size, std::align_val_t alignment)                       { return counting_new::allocate(size, static_cast<std::size_t>(alignment)); }
+void* operator new(std::size_t size, std::nothrow_t const& tag) noexcept                 { return counting_new::allocate(size, __STDCPP_DEFAULT_NEW_ALIGNMENT__, tag); }
+void* operator new[](std::size_t size, std::nothrow_t const& tag) noexcept               { return counting_new::allocate(size, __STDCPP_DEFAULT_NEW_ALIGNMENT__, tag); }
+void* operator new(std::size_t size, std::align_val_t alignment, std::nothrow_t const& tag) noexcept   { return counting_new::allocate(size, static_cast<std::size_t>(alignment), tag); }
+void* operator new[](std::size_t size, std::align_val_t alignment, std::nothrow_t const& tag) noexcept { return counting_new::allocate(size, static_cast<std::size_t>(alignment), tag); }
+
+void operator delete(void* p) noexcept                                                   { std::free(p); }
+void operator delete[](void* p) noexcept                                                 { std::free(p); }
+void operator delete(void* p, std::size_t) noexcept                                      { std::free(p); }
+void operator delete[](void* p, std::size_t) noexcept                                    { std::free(p); }
+void operator delete(void* p, std::align_val_t) noexcept                                 { std::free(p); }
+void operator delete[](void* p, std::align_val_t) noexcept                               { std::free(p); }
+void operator delete(void* p, std::size_t, std::align_val_t) noexcept                    { std::free(p); }
+void operator delete[](void* p, std::size_t, std::align_val_t) noexcept                  { std::free(p); }
+void operator delete(void* p, std::nothrow_t const&) noexcept                            { std::free(p); }
+void operator delete[](void* p, std::nothrow_t const&) noexcept                          { std::free(p); }
+void operator delete(void* p, std::align_val_t, std::nothrow_t const&) noexcept          { std::free(p); }
+void operator delete[](void* p, std::align_val_t, std::nothrow_t const&) noexcept        { std::free(p); }
@@ -0,0 +1,16 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+
+// Counters of the replaced global operator new, defined in counting_new.cpp.
+//
+// Every form of operator new, plain, array, aligned and nothrow, adds to them. The replacements
+// live in their own translation unit so the compiler never sees their malloc and free paired
+// with the new and delete expressions it inlines.
+
+namespace counting_new {
+
+	extern std::atomic<std::size_t> allocations;
+	extern std::atomic<std::size_t> allocated_bytes;
+}
@@ -0,0 +1,288 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <iterator>
+#include <vector>
+#include "associated_collection.hpp"
+#include "multiway_algo.hpp"
+#include "task_queue.hpp"
+
+// Algorithms over two associated_collections kept mirrored by emplace_associations.
+
+namespace join_detail {
+
+    template<class Iterator, class Key>
+    auto lower_bound_key(Iterator first, Iterator last, Key const& key) noexcept -> Iterator {
+        return std::lower_bound(first, last, key, [](auto const& e, Key const& k) { return e < k; });
+    }
+
+    template<class AC>
+    auto lower_bound_key(AC const& ac, typename AC::key_type const& key) noexcept {
+        return lower_bound_key(std::begin(ac), std::end(ac), key);
+    }
+
+    /**
+     * @brief One merge of @p ac1 's elements in [first, last) against its sorted
+     * associations, looking each associated key up in @p ac2 .
+     *
+     * The foreign keys of one element are sorted, so every lookup in @p ac2 starts
+     * where the previous one ended. @p match returns false to skip the remaining
+     * partners of the current element.
+     */
+    template<class AC1, class AC2, class Predicate, class Match>
+    auto join_elements(AC1 const& ac1, AC2 const& ac2,
+                       typename AC1::const_iterator first, typename AC1::const_iterator last,
+                       Predicate predicate, Match match) noexcept -> void {
+        static_assert(std::is_same_v<typename AC1::foreign_key_type, typename AC2::key_type>, "AC1's foreign key must be AC2's key.");
+        static_assert(std::is_same_v<typename AC2::foreign_key_type, typename AC1::key_type>, "AC2's foreign key must be AC1's key.");
+
+        auto const& associations = ac1.associations();
+        if (first == last or associations.empty()) {
+            return;
+        }
+
+        auto association = associations.lower_bound(first->key);
+        for (; first != last and association != std::end(associations); ++first) {
+            while (association != std::end(associations) and calgo::key(*association) < first->key) {
+                ++association;
+            }
+
+            if (not predicate(*first)) {
+                continue;
+            }
+
+            auto partner  = std::begin(ac2);
+            auto previous = std::end(associations);
+            for (; association != std::end(associations) and calgo::key(*association) == first->key; previous = association++) {
+                if (previous != std::end(associations) and *previous == *association) {
+                    continue;
+                }
+
+                partner = lower_bound_key(partner, std::end(ac2), calgo::value(*association));
+                if (partner == std::end(ac2)) {
+                    break;
+                }
+
+                if (*partner == calgo::value(*association) and not match(*first, *partner)) {
+                    break;
+                }
+            }
+        }
+    }
+
+    constexpr auto everything = [](auto const&) noexcept { return true; };
+}
+
+/**
+ * @brief Calls @p operation (a, b) for every element a of @p ac1 that passes
+ * @p predicate and every element b of @p ac2 associated with it.
+ *
+ * @tparam AC1 associated_collection whose foreign key is AC2's key.
+ * @tparam AC2 associated_collection whose foreign key is AC1's key.
+ * @tparam Predicate Unary Predicate Callable taking AC1::const_reference.
+ * @tparam BinaryOperation Callable taking (AC1::const_reference, AC2::const_reference).
+ *
+ * complexity : O(|ac1| + |associations of ac1| * log|ac2|), pairs are streamed, never stored.
+ */
+template<class AC1, class AC2, class Predicate, class BinaryOperation>
+auto join_if(AC1 const& ac1, AC2 const& ac2, Predicate predicate, BinaryOperation operation) noexcept -> void {
+    join_detail::join_elements(ac1, ac2, std::begin(ac1), std::end(ac1), predicate,
+        [&](auto const& a, auto const& b) { operation(a, b); return true; });
+}
+
+/**
+ * @brief Calls @p operation (a, b) for every associated pair of elements of @p ac1 and @p ac2.
+ */
+template<class AC1, class AC2, class BinaryOperation>
+auto join(AC1 const& ac1, AC2 const& ac2, BinaryOperation operation) noexcept -> void {
+    join_if(ac1, ac2, join_detail::everything, operation);
+}
+
+/**
+ * @brief Calls @p operation (a, b) for every associated pair whose a has a key in [ @p first_key, @p last_key ).
+ */
+template<class AC1, class AC2, class BinaryOperation>
+auto join(AC1 const& ac1, AC2 const& ac2, typename AC1::key_type const& first_key, typename AC1::key_type const& last_key,
+          BinaryOperation operation) noexcept -> void {
+    join_detail::join_elements(ac1, ac2, join_detail::lower_bound_key(ac1, first_key), join_detail::lower_bound_key(ac1, last_key),
+        join_detail::everything, [&](auto const& a, auto const& b) { operation(a, b); return true; });
+}
+
+/**
+ * @brief Calls @p operation (a) once for every element a of @p ac1 that passes
+ * @p predicate and is associated with at least one element of @p ac2 .
+ */
+template<class AC1, class AC2, class Predicate, class UnaryOperation>
+auto semi_join_if(AC1 const& ac1, AC2 const& ac2, Predicate predicate, UnaryOperation operation) noexcept -> void {
+    join_detail::join_elements(ac1, ac2, std::begin(ac1), std::end(ac1), predicate,
+        [&](auto const& a, auto const&) { operation(a); return false; });
+}
+
+/**
+ * @brief Calls @p operation (a) once for every element a of @p ac1 associated with at least one element of @p ac2 .
+ */
+template<class AC1, class AC2, class UnaryOperation>
+auto semi_join(AC1 const& ac1, AC2 const& ac2, UnaryOperation operation) noexcept -> void {
+    semi_join_if(ac1, ac2, join_detail::everything, operation);
+}
+
+/**
+ * @brief semi_join restricted to the elements of @p ac1 with a key in [ @p first_key, @p last_key ).
+ */
+template<class AC1, class AC2, class UnaryOperation>
+auto semi_join(AC1 const& ac1, AC2 const& ac2, typename AC1::key_type const& first_key, typename AC1::key_type const& last_key,
+               UnaryOperation operation) noexcept -> void {
+    join_detail::join_elements(ac1, ac2, join_detail::lower_bound_key(ac1, first_key), join_detail::lower_bound_key(ac1, last_key),
+        join_detail::everything, [&](auto const& a, auto const&) { operation(a); return false; });
+}
+
+/**
+ * @brief Number of associated pairs join_if would visit, without building any of them.
+ */
+template<class AC1, class AC2, class Predicate>
+auto join_count_if(AC1 const& ac1, AC2 const& ac2, Predicate predicate) noexcept -> std::size_t {
+    std::size_t count = 0;
+    join_detail::join_elements(ac1, ac2, std::begin(ac1), std::end(ac1), predicate,
+        [&](auto const&, auto const&) { ++count; return true; });
+    return count;
+}
+
+/**
+ * @brief Number of associated pairs of elements of @p ac1 and @p ac2 .
+ */
+template<class AC1, class AC2>
+auto join_count(AC1 const& ac1, AC2 const& ac2) noexcept -> std::size_t {
+    return join_count_if(ac1, ac2, join_detail::everything);
+}
+
+/**
+ * @brief Number of associated pairs whose a has a key in [ @p first_key, @p last_key ).
+ */
+template<class AC1, class AC2>
+auto join_count(AC1 const& ac1, AC2 const& ac2, typename AC1::key_type const& first_key, typename AC1::key_type const& last_key) noexcept -> std::size_t {
+    std::size_t count = 0;
+    join_detail::join_elements(ac1, ac2, join_detail::lower_bound_key(ac1, first_key), join_detail::lower_bound_key(ac1, last_key),
+        join_detail::everything, [&](auto const&, auto const&) { ++count; return true; });
+    return count;
+}
+
+/**
+ * @brief Keys reached by reachable(), sorted and unique on each side.
+ */
+template<class AC1, class AC2>
+struct reachable_keys {
+    std::vector<typename AC1::key_type> first;
+    std::vector<typename AC2::key_type> second;
+    std::size_t                         depth{ 0 };
+};
+
+namespace reach_detail {
+
+    // Appends the foreign keys of every key in [first, last), both sorted, in one forward pass over the
+    // associations, then sorts what it appended. Each key's run is sorted already, but merging a
+    // frontier's many short runs through a loser tree is slower than sorting them together.
+    template<class AC, class Iterator, class Foreign>
+    auto expand_keys(AC const& ac, Iterator first, Iterator last, Foreign& out) noexcept -> void {
+        auto const& associations = ac.associations();
+        auto association = std::begin(associations);
+        for (; first != last and association != std::end(associations); ++first) {
+            association = std::lower_bound(association, std::end(associations), *first,
+                [](auto const& a, auto const& k) { return calgo::key(a) < k; });
+            for (; association != std::end(associations) and calgo::key(*association) == *first; ++association) {
+                out.push_back(calgo::value(*association));
+            }
+        }
+        calgo::sort(out);
+    }
+
+    template<class AC, class Keys, class Foreign>
+    auto expand(AC const& ac, Keys const& frontier, Foreign& next, task_system* tasks) -> void {
+        if (tasks == nullptr or frontier.size() < 2) {
+            expand_keys(ac, std::begin(frontier), std::end(frontier), next);
+            return;
+        }
+
+        const auto parts = static_cast<unsigned>(std::min<std::size_t>(tasks->concurrency() + 1, frontier.size()));
+        std::vector<Foreign> partial(parts);
+        tasks->fork_join(parts, [&](unsigned part) {
+            expand_keys(ac, std::next(std::begin(frontier), frontier.size() * part / parts),
+                            std::next(std::begin(frontier), frontier.size() * (part + 1) / parts), partial[part]);
+        });
+
+        // Every part sorted its own keys, the few long runs left are merged in one pass.
+        calgo::multiway_set_union(partial, [&](auto const& key) { next.push_back(key); });
+    }
+
+    // Leaves in next, sorted by expand, only the keys not visited yet, then adds them to visited.
+    template<class Keys>
+    auto advance(Keys& next, Keys& visited) -> void {
+        calgo::erase_duplicates(next);
+
+        Keys fresh;
+        fresh.reserve(next.size());
+        std::set_difference(std::begin(next), std::end(next), std::begin(visited), std::end(visited), std::back_inserter(fresh));
+
+        const auto middle = static_cast<std::ptrdiff_t>(visited.size());
+        visited.insert(std::end(visited), std::begin(fresh), std::end(fresh));
+        std::inplace_merge(std::begin(visited), std::next(std::begin(visited), middle), std::end(visited));
+        next.swap(fresh);
+    }
+
+    template<class AC1, class AC2, class Keys>
+    auto reachable(AC1 const& ac1, AC2 const& ac2, Keys const& sources, std::size_t max_depth, task_system* tasks) -> reachable_keys<AC1, AC2> {
+        static_assert(std::is_same_v<typename AC1::foreign_key_type, typename AC2::key_type>, "AC1's foreign key must be AC2's key.");
+        static_assert(std::is_same_v<typename AC2::foreign_key_type, typename AC1::key_type>, "AC2's foreign key must be AC1's key.");
+
+        reachable_keys<AC1, AC2> reached;
+        reached.first.assign(std::begin(sources), std::end(sources));
+        calgo::sort(reached.first);
+        calgo::erase_duplicates(reached.first);
+
+        auto first_frontier = reached.first;
+        decltype(reached.second) second_frontier;
+        while (reached.depth < max_depth) {
+            if (reached.depth % 2 == 0) {
+                second_frontier.clear();
+                expand(ac1, first_frontier, second_frontier, tasks);
+                advance(second_frontier, reached.second);
+                if (second_frontier.empty()) break;
+            } else {
+                first_frontier.clear();
+                expand(ac2, second_frontier, first_frontier, tasks);
+                advance(first_frontier, reached.first);
+                if (first_frontier.empty()) break;
+            }
+            ++reached.depth;
+        }
+        return reached;
+    }
+}
+
+/**
+ * @brief Breadth first search from the @p sources keys of @p ac1 , hopping across the
+ * associations of @p ac1 and @p ac2 alternately, up to @p max_depth hops.
+ *
+ * Frontiers are sorted vectors, each level expands with one forward pass over the
+ * associations and drops already visited keys with a merge, so no key is expanded twice.
+ *
+ * @tparam AC1 associated_collection whose foreign key is AC2's key.
+ * @tparam AC2 associated_collection whose foreign key is AC1's key.
+ * @tparam Keys iterable range of AC1::key_type.
+ * @param sources keys the search starts from, counted as reached at depth 0.
+ * @param max_depth number of hops, 1 only reaches keys of @p ac2 .
+ * @return every key reached on each side and the number of hops that found new keys.
+ */
+template<class AC1, class AC2, class Keys>
+auto reachable(AC1 const& ac1, AC2 const& ac2, Keys const& sources, std::size_t max_depth) -> reachable_keys<AC1, AC2> {
+    return reach_detail::reachable(ac1, ac2, sources, max_depth, nullptr);
+}
+
+/**
+ * @brief Same as reachable(ac1, ac2, sources, max_depth) but every frontier is split
+ * across the workers of @p tasks to be expanded in parallel.
+ */
+template<class AC1, class AC2, class Keys>
+auto reachable(AC1 const& ac1, AC2 const& ac2, Keys const& sources, std::size_t max_depth, task_system& tasks) -> reachable_keys<AC1, AC2> {
+    return reach_detail::reachable(ac1, ac2, sources, max_depth, &tasks);
+}
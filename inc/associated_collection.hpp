@@ -1,9 +1,17 @@
+#pragma once
 
-
+#include <memory>
+#include <memory_resource>
+#include <unordered_map>
 #include <vector> 
 #include <boost/container/flat_map.hpp>
 #include <boost/container/flat_set.hpp>
+#include "change_log.hpp"
 #include "container_algo.hpp"
+#include "hash_algo.hpp"
+#include "packed_key.hpp"
+#include "range_views.hpp"
+#include "task_queue.hpp"
 
 // Maps types to void
 template<class...>
@@ -22,19 +30,24 @@ template<
          class Element,
          class Foreign_key  = decltype( Element::key ),
          class Key          = decltype( Element::key ),
-         class Contributors = Foreign_key
+         class Contributors = Foreign_key,
+         class Allocator    = std::allocator<Element>
         >
 class associated_collection {
 
     static_assert(is_associatable<Element>, "Element must contain a key member field.");
 
-    template<class... Ts>
-    using set = boost::container::flat_set<Ts...>;
+    template<class T>
+    using allocator_for = typename std::allocator_traits<Allocator>::template rebind_alloc<T>;
+
+    template<class T>
+    using set = boost::container::flat_set<T, std::less<T>, allocator_for<T>>;
 
-    template<class... Ts>
-    using map = boost::container::flat_multimap<Ts...>;
+    template<class K, class V>
+    using map = boost::container::flat_multimap<K, V, std::less<K>, allocator_for<std::pair<K, V>>>;
 
 public: 
+    using allocator_type          = Allocator;
     using key_type                = Key;
     using foreign_key_type        = Foreign_key;
     using value_type              = Element;
@@ -52,6 +65,7 @@ public:
     using size_type               = typename collection_type::size_type;
     using iterator                = typename collection_type::iterator;
     using const_iterator          = typename collection_type::const_iterator;
+    using degree_type             = std::unordered_map<key_type, size_type, calgo::hash, std::equal_to<key_type>, allocator_for<std::pair<key_type const, size_type>>>;
 
     using aiterator               = typename association_type::iterator;
     using const_aiterator         = typename association_type::const_iterator;
@@ -59,51 +73,307 @@ public:
     using areference              = avalue_type&;
     using aconst_reference        = avalue_type const&;
 
+    using change_log_type         = change_log<Element, key_type, foreign_key_type, Allocator>;
+    using change_type             = typename change_log_type::change_type;
+
+    struct container_usage {
+        std::size_t size;
+        std::size_t capacity;
+        std::size_t bytes;
+    };
+
+    struct memory_usage_type {
+        container_usage collection;
+        container_usage associations;
+        container_usage degrees;
+        container_usage contributors;
+        container_usage keys;
+        container_usage foreign_keys;
+        container_usage changes;
+
+        constexpr auto total_bytes() const noexcept -> std::size_t {
+            return collection.bytes + associations.bytes + degrees.bytes + contributors.bytes + keys.bytes + foreign_keys.bytes + changes.bytes;
+        }
+    };
+
 
 private:
 
     collection_type         collection_;
     association_type        associations_;
+    degree_type             degrees_;
     contributors_type       contributors_;
 
     key_collection_type     keys_;
     foreign_collection_type foreign_keys_;
+
+    change_log_type         changes_;
+    bool                    tracking_{ false };
    
 public:
 
+    associated_collection() = default;
+
+    /**
+     * @brief Builds an empty collection whose internal containers all allocate from @p allocator.
+     */
+    explicit associated_collection(allocator_type const& allocator)
+        : collection_(allocator_for<value_type>(allocator))
+        , associations_(allocator_for<avalue_type>(allocator))
+        , degrees_(allocator_for<typename degree_type::value_type>(allocator))
+        , contributors_(allocator_for<typename contributors_type::value_type>(allocator))
+        , keys_(allocator_for<key_type>(allocator))
+        , foreign_keys_(allocator_for<typename foreign_collection_type::value_type>(allocator))
+        , changes_(allocator_for<change_type>(allocator))
+    { }
+
+    /**
+     * @brief Builds a collection from ranges already ordered the way the
+     * internal containers keep them, so nothing gets re-sorted.
+     * 
+     * @param elements sorted unique elements.
+     * @param associations (key, foreign key) pairs sorted by key then foreign key.
+     * @param contributions (key, contributor) pairs sorted by key.
+     * @param allocator every internal container allocates from.
+     */
+    template<class Elements, class Associations, class Contributions>
+    associated_collection(boost::container::ordered_range_t, Elements const& elements, 
+                          Associations const& associations, Contributions const& contributions,
+                          allocator_type const& allocator = allocator_type{})
+        : collection_(boost::container::ordered_unique_range, std::begin(elements), std::end(elements), 
+                      std::less<value_type>{}, allocator_for<value_type>(allocator))
+        , associations_(boost::container::ordered_range, std::begin(associations), std::end(associations), 
+                        std::less<key_type>{}, allocator_for<avalue_type>(allocator))
+        , degrees_(allocator_for<typename degree_type::value_type>(allocator))
+        , contributors_(boost::container::ordered_range, std::begin(contributions), std::end(contributions), 
+                        std::less<key_type>{}, allocator_for<typename contributors_type::value_type>(allocator))
+        , keys_(allocator_for<key_type>(allocator))
+        , foreign_keys_(allocator_for<typename foreign_collection_type::value_type>(allocator))
+        , changes_(allocator_for<change_type>(allocator))
+    {
+        add_degrees(std::begin(associations_), std::end(associations_));
+    }
+
+    allocator_type                 get_allocator() const noexcept { return allocator_type(collection_.get_allocator()); }
+
     contributors_type       const& contributors() const noexcept { return contributors_; }
     association_type        const& associations() const noexcept { return associations_; }
+    degree_type             const& degrees()      const noexcept { return degrees_; } ///< keys hashed with calgo::hash, in no particular order.
     key_collection_type     const& keys()         const noexcept { return keys_; }
     foreign_collection_type const& foreign_keys() const noexcept { return foreign_keys_; }
     key_collection_type     &      borrow_keys()        noexcept { return keys_; }
+    change_log_type         const& changes()      const noexcept { return changes_; }
+    change_log_type         &      borrow_changes()     noexcept { return changes_; }
     size_type                      size()         const noexcept { return collection_.size(); }
     const_iterator                 begin()        const noexcept { return collection_.cbegin(); }    
     const_iterator                 end()          const noexcept { return collection_.cend();   }
     iterator                       begin()              noexcept { return std::begin(collection_);     }    
     iterator                       end()                noexcept { return std::end(collection_);       }
 
+    /**
+     * @brief Reserves room for @p new_capacity elements. The other containers
+     * grow on their own, they rarely match the number of elements.
+     */
     void reserve(std::size_t new_capacity) noexcept {
         collection_.reserve(new_capacity);
-        associations_.reserve(new_capacity);
-        contributors_.reserve(new_capacity);
-        keys_.reserve(new_capacity);
-        foreign_keys_.reserve(new_capacity);
     }
 
+    /**
+     * @brief Reserves room for @p element_capacity elements and @p association_capacity associations.
+     */
+    void reserve(std::size_t element_capacity, std::size_t association_capacity) noexcept {
+        collection_.reserve(element_capacity);
+        associations_.reserve(association_capacity);
+    }
+
+    /**
+     * @brief Size, capacity and bytes held by each internal container.
+     */
+    auto memory_usage() const noexcept -> memory_usage_type {
+        return { usage(collection_), usage(associations_), usage(degrees_), usage(contributors_),
+                 usage(keys_), usage(foreign_keys_), usage(changes_) };
+    }
+
+    /**
+     * @brief Gives back the unused capacity of every internal container.
+     */
+    void shrink_to_fit() noexcept {
+        collection_.shrink_to_fit();
+        associations_.shrink_to_fit();
+        degrees_.rehash(0);
+        contributors_.shrink_to_fit();
+        keys_.shrink_to_fit();
+        foreign_keys_.shrink_to_fit();
+        changes_.shrink_to_fit();
+    }
+
+    /**
+     * @brief Clears the foreign_keys() scratch left by previous erases, then shrink_to_fit().
+     * Meant for long lived collections to let go of their peak sized allocations.
+     */
+    void compact() noexcept {
+        foreign_keys_.clear();
+        shrink_to_fit();
+    }
+
+    /**
+     * @brief Starts or stops recording every mutation into changes().
+     * Off by default, nothing is recorded and nothing is paid until it's turned on.
+     */
+    void track_changes(bool enable) noexcept { tracking_ = enable; }
+
     template<class... Args>
     void emplace(Args&&... values) noexcept {
-        collection_.emplace(std::forward<Args>(values)...);
+        auto [location, inserted] = collection_.emplace(std::forward<Args>(values)...);
+        if (inserted) {
+            record(typename change_log_type::element_inserted{ *location });
+        }
     }
 
     template<class... Args>
     void emplace_association(Args&&... values) noexcept {
         auto location = associations_.emplace(std::forward<Args>(values)...);
+        record(typename change_log_type::association_added{ location->first, location->second });
+        ++degrees_[location->first];
         auto range    = associations_.equal_range(location->first);
         std::sort(range.first, range.second);
     }
+
+    /**
+     * @brief Inserts the elements of [ @p first, @p last ) with one sort of the
+     * batch and one merge, instead of shifting the collection once per element.
+     * Elements with packable keys are radix sorted.
+     */
+    template<class Iterator>
+    void insert(Iterator first, Iterator last) {
+        std::vector<value_type, allocator_for<value_type>> batch(first, last, allocator_for<value_type>(get_allocator()));
+        sort_by(batch, [](const_reference e) -> key_type const& { return e.key; });
+        calgo::erase_duplicates_if(batch, [](const_reference a, const_reference b) { return not (a < b) and not (b < a); });
+
+        if (tracking_) {
+            for (auto& element : batch) {
+                emplace(std::move(element));
+            }
+            return;
+        }
+        collection_.insert(boost::container::ordered_unique_range, std::begin(batch), std::end(batch));
+    }
+
+    /**
+     * @brief Inserts the (key, foreign key) pairs of [ @p first, @p last ) with one
+     * sort of the batch and one merge, radix sorted when the pairs are packable.
+     */
+    template<class Iterator>
+    void insert_associations(Iterator first, Iterator last) {
+        std::vector<avalue_type, allocator_for<avalue_type>> batch(first, last, allocator_for<avalue_type>(get_allocator()));
+        calgo::sort(batch);
+
+        const bool had_associations = not associations_.empty();
+        associations_.insert(boost::container::ordered_range, std::begin(batch), std::end(batch));
+        add_degrees(std::begin(batch), std::end(batch));
+        for (auto run = std::begin(batch); run != std::end(batch); ) {
+            auto next = std::find_if(run, std::end(batch), [&](aconst_reference a) { return not (a.first == run->first); });
+            if (had_associations) {
+                auto range = associations_.equal_range(run->first);
+                std::sort(range.first, range.second);
+            }
+            if (tracking_) {
+                for (auto const& association : calgo::iterable(run, next)) {
+                    changes_.record(typename change_log_type::association_added{ association.first, association.second });
+                }
+            }
+            run = next;
+        }
+    }
+
+    /**
+     * @brief Replays one change recorded by another collection's change log.
+     * 
+     * Applies exactly the recorded mutation, no cascading, since the cascaded
+     * mutations were recorded as changes of their own.
+     */
+    auto apply(change_type const& change) noexcept -> void {
+        std::visit(calgo::overload{
+            [&](typename change_log_type::element_inserted const& c) { emplace(c.element); },
+            [&](typename change_log_type::element_erased const& c) {
+                auto location = std::lower_bound(std::begin(collection_), std::end(collection_), c.key,
+                    [](const_reference e, key_type const& k) { return e < k; });
+                if (location != std::end(collection_) and *location == c.key) {
+                    collection_.erase(location);
+                    contributors_.erase(c.key);
+                    record(c);
+                }
+            },
+            [&](typename change_log_type::association_added const& c) { emplace_association(c.key, c.foreign_key); },
+            [&](typename change_log_type::association_removed const& c) {
+                auto range    = associations_.equal_range(c.key);
+                auto location = std::find_if(range.first, range.second, [&](aconst_reference a) { return calgo::value(a) == c.foreign_key; });
+                if (location != range.second) {
+                    associations_.erase(location);
+                    if (release(c.key)) {
+                        degrees_.erase(c.key);
+                    }
+                    record(c);
+                }
+            }
+        }, change);
+    }
+
+    /**
+     * @brief Replays every change of @p changes in order, see apply(change_type const&).
+     */
+    template<class Changes>
+    auto apply(Changes const& changes) noexcept -> void {
+        for (auto const& change : changes) {
+            apply(change);
+        }
+    }
     
+    /**
+     * @brief Number of associations of the key @p k , 0 if it has none. Expected O(1),
+     * the counts are kept in a hash map kept up to date by every mutation.
+     */
+    auto degree(key_type const& k) const noexcept -> size_type {
+        auto location = degrees_.find(k);
+        return location == std::end(degrees_) ? 0 : location->second;
+    }
+
+    /**
+     * @brief Calls @p operation (key, degree) for every key that has associations,
+     * from the most associated to the least, keys of equal degree in key order.
+     * Meant to hand out the heaviest keys first when splitting work.
+     */
+    template<class BinaryOperation>
+    auto visit_by_degree(BinaryOperation operation) const -> void {
+        using entry_iterator = typename degree_type::const_iterator;
+        std::vector<entry_iterator, allocator_for<entry_iterator>> order{ allocator_for<entry_iterator>(get_allocator()) };
+        order.reserve(degrees_.size());
+        for (auto entry = std::begin(degrees_); entry != std::end(degrees_); ++entry) {
+            order.push_back(entry);
+        }
+        std::sort(std::begin(order), std::end(order), [](entry_iterator a, entry_iterator b) {
+            return a->second > b->second or (a->second == b->second and a->first < b->first);
+        });
+        for (auto entry : order) {
+            operation(entry->first, entry->second);
+        }
+    }
+
+    /**
+     * @brief Erases the element keyed @p k and its associations.
+     * 
+     * @return the foreign_keys() scratch with the (foreign key, key) pairs the mirrored
+     * collection has to erase appended to it, it keeps growing until the caller clears it.
+     */
     auto erase(key_type const& k) noexcept -> foreign_collection_type& {
-       return erase_if([&](const_reference e) { return e == k; });
+       return erase(k, foreign_keys_);
+    }
+
+    /**
+     * @brief Same as erase(k) but the (foreign key, key) pairs are appended to @p erased .
+     */
+    auto erase(key_type const& k, foreign_collection_type& erased) noexcept -> foreign_collection_type& {
+       return erase_if([&](const_reference e) { return e == k; }, erased);
     }
 
     auto compare_associations(key_type const& a, key_type const& b) noexcept -> bool {
@@ -112,39 +382,60 @@ public:
         return calgo::equal_values(a_range, b_range);
     }
 
+    /**
+     * @brief Erases the (key, foreign key) associations of @p set_of_assocations , then the
+     * elements whose last association went away, then every element associated with exactly
+     * the foreign keys of an element of smaller key. The collection stays sorted.
+     * 
+     * @return the foreign_keys() scratch with the (foreign key, key) pairs of the erased duplicates appended.
+     */
     auto erase(inverse_foreign_type const& set_of_assocations) noexcept -> foreign_collection_type& {
+        return erase(set_of_assocations, foreign_keys_);
+    }
+
+    /**
+     * @brief Same as erase(set_of_assocations) but the (foreign key, key) pairs of
+     * elements erased along the way are appended to @p erased .
+     */
+    auto erase(inverse_foreign_type const& set_of_assocations, foreign_collection_type& erased) noexcept -> foreign_collection_type& {
+        // Keys whose last association went away, in key order as the associations are visited in it.
+        std::vector<key_type, allocator_for<key_type>> orphans{ allocator_for<key_type>(get_allocator()) };
         calgo::erase_if(associations_, [&](avalue_type value){
             if (calgo::contains(set_of_assocations, value)) {
-                if (calgo::equals_one(associations_.count(value.first))) {
-                    calgo::erase_value(collection_, value.first);
-                    contributors_.erase(value.first);
+                record(typename change_log_type::association_removed{ value.first, value.second });
+                if (release(value.first)) {
+                    orphans.push_back(value.first);
                 }
                 return true;
             }
             return false;
         });
 
-        calgo::sort(collection_, [&](const_reference a, const_reference b){
-            if(compare_associations(a.key, b.key)) return true;
-            else return calgo::value(a.key) < calgo::value(b.key);
-        });
-        
-        calgo::erase_duplicates_if(collection_, [&](const_reference a, const_reference b){
-            bool equal = compare_associations(a.key, b.key);
-            if (equal) {
-                auto range = inverse_assocations(b.key);
-                associations_.erase(range.first, range.second);
-                contributors_.erase(b.key);
-            }
-            return equal;
-        });
-        return foreign_keys_;
+        // Only the orphans are looked up, keys with associations but no element have nothing to
+        // erase, and nothing is recorded for them.
+        if (not orphans.empty()) {
+            if (tracking_) {
+                calgo::find_each(collection_, orphans, [&](key_type const& key, const_iterator location) {
+                    if (location != std::end(collection_)) {
+                        changes_.record(typename change_log_type::element_erased{ key });
+                    }
+                }, by_key{});
+            }
+            calgo::erase_values(collection_,   orphans, by_key{});
+            calgo::erase_values(contributors_, orphans, by_key{});
+            for (auto const& key : orphans) {
+                degrees_.erase(key);
+            }
+        }
+
+        erase_duplicate_associations(erased);
+        return erased;
     }
 
     template<class Foreign, class UnaryOperation>
     auto visit (Foreign const& foreign_key, UnaryOperation operation) noexcept -> void {
         static_assert(std::is_same_v<Foreign, foreign_key_type>, "Visited Key must be the foreign key.\n");
-        calgo::set_intersection(collection_, associations_, operation, calgo::overload{
+        calgo::set_intersection_merge(collection_, associations_, operation, calgo::overload{
             [&](reference a, areference b){ 
                 if (calgo::value(b) == foreign_key and calgo::key(b) == a){  
                     return false; 
@@ -162,34 +453,273 @@ public:
         });
     }
 
+    /**
+     * @brief Visits every element associated with any of the @p foreign_keys
+     * in one merged pass over the associations.
+     * 
+     * The query keys are sorted and deduplicated first and repeated associations
+     * are skipped, so each matching (foreign key, element) pair is visited exactly
+     * once, ordered by element key.
+     * 
+     * @tparam ForeignKeys iterable range of foreign_key_type.
+     * @tparam BinaryOperation Callable taking (foreign_key_type const&, const_reference).
+     * @param foreign_keys keys to visit, any order, duplicates allowed.
+     * @param operation called once per associated (foreign key, element) pair.
+     */
+    template<class ForeignKeys, class BinaryOperation>
+    auto visit_many(ForeignKeys const& foreign_keys, BinaryOperation operation) const noexcept -> void {
+        const auto query = sorted_query(foreign_keys);
+        visit_range(query, std::begin(associations_), std::end(associations_), operation);
+    }
+
+    /**
+     * @brief Same as visit_many(foreign_keys, operation) but the associations
+     * are split into one part per worker of @p tasks and visited in parallel.
+     * 
+     * Thread-safety contract for @p operation :
+     *  - it is called concurrently from the pool's worker threads and from the caller.
+     *  - every (foreign key, element) pair is still visited exactly once, in no particular order.
+     *  - it must not mutate this collection, and any state it shares must be synchronized.
+     * Blocks until every part is done, see task_system::fork_join.
+     * 
+     * @tparam ForeignKeys iterable range of foreign_key_type.
+     * @tparam BinaryOperation Callable taking (foreign_key_type const&, const_reference).
+     * @param foreign_keys keys to visit, any order, duplicates allowed.
+     * @param operation called once per associated (foreign key, element) pair.
+     * @param tasks pool that the parts are ran on.
+     */
+    template<class ForeignKeys, class BinaryOperation>
+    auto visit_many(ForeignKeys const& foreign_keys, BinaryOperation operation, task_system& tasks) const noexcept -> void {
+        const auto query = sorted_query(foreign_keys);
+        if (query.empty() or associations_.empty()) {
+            return;
+        }
+
+        const auto total = associations_.size();
+        const auto parts = static_cast<unsigned>(std::min<size_type>(tasks.concurrency() + 1, total));
+        const auto boundary = [&](unsigned part) {
+            if (part == parts) return std::end(associations_);
+            return associations_.lower_bound(calgo::key(*std::next(std::begin(associations_), total * part / parts)));
+        };
+
+        tasks.fork_join(parts, [&](unsigned part) {
+            visit_range(query, boundary(part), boundary(part + 1), operation);
+        });
+    }
+
 private:
 
-    auto inverse_assocations(key_type key) noexcept {
+    using query_type = std::vector<foreign_key_type, allocator_for<foreign_key_type>>;
+
+    template<class ForeignKeys>
+    auto sorted_query(ForeignKeys const& foreign_keys) const -> query_type {
+        static_assert(calgo::is_iterable<ForeignKeys>, "Must be iterable [have begin() and end() functions.]");
+        query_type query(std::begin(foreign_keys), std::end(foreign_keys), allocator_for<foreign_key_type>(get_allocator()));
+        calgo::sort(query);
+        calgo::erase_duplicates(query);
+        return query;
+    }
+
+    template<class BinaryOperation>
+    auto visit_range(query_type const& query, const_aiterator first, const_aiterator last, BinaryOperation& operation) const noexcept -> void {
+        if (query.empty() or first == last) {
+            return;
+        }
+
+        auto element = std::lower_bound(std::begin(collection_), std::end(collection_), calgo::key(*first),
+            [](const_reference e, key_type const& k) { return e < k; });
+
+        for (auto previous = last; first != last and element != std::end(collection_); previous = first++) {
+            if (previous != last and *previous == *first) {
+                continue;
+            }
+
+            while (element != std::end(collection_) and *element < calgo::key(*first)) {
+                ++element;
+            }
+
+            if (element != std::end(collection_) and *element == calgo::key(*first) and
+                std::binary_search(std::begin(query), std::end(query), calgo::value(*first))) {
+                operation(first->second, *element);
+            }
+        }
+    }
+
+    template<class Container, class Projection>
+    static void sort_by(Container& container, Projection projection) {
+        using projected_t = std::remove_cvref_t<decltype(projection(*std::begin(container)))>;
+        if constexpr (calgo::is_packable<projected_t>) {
+            calgo::radix_sort(container, projection);
+        } else {
+            calgo::sort(container, [&](auto const& a, auto const& b) { return projection(a) < projection(b); });
+        }
+    }
+
+    template<class Container>
+    static auto usage(Container const& container) noexcept -> container_usage {
+        return { container.size(), container.capacity(), container.capacity() * sizeof(typename Container::value_type) };
+    }
+
+    // The bucket array and one node per count, node bookkeeping estimated as a next pointer and the cached hash.
+    static auto usage(degree_type const& degrees) noexcept -> container_usage {
+        constexpr auto node_bytes = sizeof(typename degree_type::value_type) + sizeof(void*) + sizeof(std::size_t);
+        return { degrees.size(), degrees.bucket_count(), degrees.bucket_count() * sizeof(void*) + degrees.size() * node_bytes };
+    }
+
+    auto inverse_assocations(key_type key, foreign_collection_type& erased) noexcept {
         auto range = associations_.equal_range(key);
-        calgo::transform (
-            calgo::iterable(range), 
-            calgo::back_inserter(foreign_keys_), 
-            [](auto r){ return calgo::reverse(r); }
-        );
+        calgo::iterable(range)
+            | calgo::views::transform([](aconst_reference r) { return calgo::reverse(r); })
+            | calgo::views::into(erased);
         return range;
     }
 
+    // Adds the associations of [first, last), sorted by key, to their keys' degrees.
+    template<class Iterator>
+    void add_degrees(Iterator first, Iterator last) {
+        for (auto run = first; run != last; ) {
+            auto next = std::find_if(run, last, [&](aconst_reference a) { return not (a.first == run->first); });
+            degrees_[run->first] += static_cast<size_type>(std::distance(run, next));
+            run = next;
+        }
+    }
+
+    // Takes one association off the degree of @p key , true once it has none left.
+    auto release(key_type const& key) noexcept -> bool {
+        auto degree = degrees_.find(key);
+        return degree != std::end(degrees_) and --degree->second == 0;
+    }
+
+    template<class Change>
+    void record(Change&& change) noexcept {
+        if (tracking_) {
+            changes_.record(std::forward<Change>(change));
+        }
+    }
+
+    // Erases, with their associations, the elements associated with exactly the same foreign keys
+    // as an element of smaller key, elements without associations included. Groups are found by
+    // hashing each element's run of associations, collection_ stays in key order.
+    void erase_duplicate_associations(foreign_collection_type& erased) {
+        using run_type = std::pair<std::size_t, calgo::iterable<const_aiterator>>;
+        std::vector<run_type, allocator_for<run_type>> runs{ allocator_for<run_type>(get_allocator()) };
+        runs.reserve(collection_.size());
+
+        auto association = std::cbegin(associations_);
+        for (const_reference element : collection_) {
+            association = std::lower_bound(association, std::cend(associations_), element.key,
+                [](aconst_reference a, key_type const& k) { return a.first < k; });
+            const auto first = association;
+            std::size_t hash = 0;
+            for (; association != std::cend(associations_) and association->first == element.key; ++association) {
+                hash ^= calgo::hash{}(association->second) + 0x9e3779b97f4a7c15 + (hash << 6) + (hash >> 2);
+            }
+            runs.emplace_back(hash, calgo::iterable{ first, association });
+        }
+
+        std::vector<key_type, allocator_for<key_type>> duplicates{ allocator_for<key_type>(get_allocator()) };
+        calgo::hash_detail::with_table(runs.size(), [&](auto table) {
+            for (std::size_t i = 0; i != runs.size(); ++i) {
+                auto& slot = table.probe(runs[i].first, [&](auto entry) {
+                    auto const& seen = runs[table.position(entry)];
+                    return seen.first == runs[i].first and calgo::equal_values(seen.second, runs[i].second);
+                });
+                if (slot == 0) {
+                    slot = table.entry(i);
+                } else {
+                    duplicates.push_back(collection_.nth(i)->key);
+                }
+            }
+        });
+
+        erase_elements(duplicates, erased);
+    }
+
+    // Orders elements, keys and (key, value) pairs by key, for the calgo algorithms taking sorted keys.
+    struct by_key {
+        template<class T>
+        static auto key_of(T const& value) noexcept -> key_type const& {
+            if constexpr (std::is_same_v<T, key_type>) return value;
+            else if constexpr (std::is_same_v<T, value_type>) return value.key;
+            else return value.first;
+        }
+
+        template<class A, class B>
+        auto operator()(A const& a, B const& b) const noexcept -> bool { return key_of(a) < key_of(b); }
+    };
+
+    // Erases the elements of the sorted @p keys , all in the collection, with their associations and
+    // contributors, one compaction pass over each container instead of one shift per element.
+    template<class Keys>
+    void erase_elements(Keys const& keys, foreign_collection_type& erased) {
+        if (std::empty(keys)) {
+            return;
+        }
+
+        using inverse_type = typename foreign_collection_type::value_type;
+        std::vector<inverse_type, allocator_for<inverse_type>> inverse{ allocator_for<inverse_type>(get_allocator()) };
+        auto key = std::begin(keys);
+        auto less = by_key{};
+        calgo::erase_if(associations_, [&](aconst_reference a) {
+            key = calgo::seek(key, std::end(keys), a.first, less);
+            if (key == std::end(keys) or a.first < *key) {
+                return false;
+            }
+            record(typename change_log_type::association_removed{ a.first, a.second });
+            inverse.push_back(calgo::reverse(a));
+            return true;
+        });
+        erased.insert(std::begin(inverse), std::end(inverse));
+
+        for (auto const& k : keys) {
+            record(typename change_log_type::element_erased{ k });
+            degrees_.erase(k);
+        }
+        calgo::erase_values(collection_,   keys, by_key{});
+        calgo::erase_values(contributors_, keys, by_key{});
+    }
+
+    // Erases the associations and contributors of an element about to be erased, recording all of it.
+    void erase_associations_of(key_type const& key, foreign_collection_type& erased) noexcept {
+        auto range = inverse_assocations(key, erased);
+        if (tracking_) {
+            for (auto const& association : calgo::iterable(range)) {
+                changes_.record(typename change_log_type::association_removed{ association.first, association.second });
+            }
+            changes_.record(typename change_log_type::element_erased{ key });
+        }
+        associations_.erase(range.first, range.second);
+        degrees_.erase(key);
+        contributors_.erase(key);
+    }
+
     template<class Predicate>
-    auto erase_if (Predicate predicate) noexcept -> foreign_collection_type& {
+    auto erase_if (Predicate predicate, foreign_collection_type& erased) noexcept -> foreign_collection_type& {
        calgo::erase_if(collection_,
         [&](const_reference element) {
             if (predicate(element)) {
-                auto range = inverse_assocations(element.key);
-                associations_.erase(range.first, range.second);
-                contributors_.erase(element.key);
+                erase_associations_of(element.key, erased);
                 return true;
             }
             return false;
         });
-        return foreign_keys_;
+        return erased;
     }
 };
 
+namespace pmr {
+    /**
+     * @brief associated_collection whose internal containers allocate from a std::pmr::memory_resource.
+     */
+    template<
+             class Element,
+             class Foreign_key  = decltype( Element::key ),
+             class Key          = decltype( Element::key ),
+             class Contributors = Foreign_key
+            >
+    using associated_collection = ::associated_collection<Element, Foreign_key, Key, Contributors, std::pmr::polymorphic_allocator<Element>>;
+}
+
 template<class AC1, class AC2>
 void emplace_associations(AC1& ac1, AC2& ac2, typename AC1::key_type const& k1, typename AC2::key_type const& k2){
     ac1.emplace_association(k1,k2);
@@ -0,0 +1,349 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <memory>
+#include <new>
+#include <optional>
+#include <span>
+#include <utility>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "associated_collection.hpp"
+
+/**
+ * @brief Fixed layout header at the start of every snapshot file.
+ * 
+ * The three sorted arrays of an associated_collection follow it, each starting
+ * at a multiple of alignment so they can be used in place once mapped.
+ */
+struct snapshot_header {
+    static constexpr std::uint64_t magic_value     = 0x31504e5343415341; // "ASACSNP1"
+    static constexpr std::uint32_t current_version = 1;
+    static constexpr std::uint32_t endian_value    = 0x01020304;
+    static constexpr std::uint64_t alignment       = 64;
+
+    std::uint64_t magic;
+    std::uint32_t version;
+    std::uint32_t endian;
+    std::uint32_t element_size;
+    std::uint32_t association_size;
+    std::uint32_t contributor_size;
+    std::uint32_t reserved;
+    std::uint64_t type_hash;
+    std::uint64_t element_count;
+    std::uint64_t association_count;
+    std::uint64_t contributor_count;
+    std::uint64_t element_offset;
+    std::uint64_t association_offset;
+    std::uint64_t contributor_offset;
+    std::uint64_t file_size;
+};
+
+namespace snapshot_detail {
+
+    /**
+     * @brief FNV-1a hash of the compiler's spelling of @p T, so a snapshot can't be
+     * opened as a different collection type that happens to have the same sizes.
+     * The spelling is compiler specific, snapshots only open with the compiler family that wrote them.
+     */
+    template<class T>
+    constexpr auto type_hash() noexcept -> std::uint64_t {
+        std::uint64_t hash = 0xcbf29ce484222325;
+        for (char const* c = __PRETTY_FUNCTION__; *c != '\0'; ++c) {
+            hash = (hash ^ static_cast<unsigned char>(*c)) * 0x100000001b3;
+        }
+        return hash;
+    }
+
+    constexpr auto align_up(std::uint64_t offset) noexcept -> std::uint64_t {
+        return (offset + snapshot_header::alignment - 1) / snapshot_header::alignment * snapshot_header::alignment;
+    }
+
+    template<class Range>
+    auto write_section(std::FILE* file, std::uint64_t& position, std::uint64_t offset, Range const& range) noexcept -> bool {
+        static const char padding[snapshot_header::alignment]{};
+        if (std::fwrite(padding, 1, offset - position, file) != offset - position) {
+            return false;
+        }
+
+        position = offset;
+        const auto count = static_cast<std::size_t>(calgo::distance(range));
+        if (count == 0) {
+            return true;
+        }
+
+        using value_t = typename Range::value_type;
+        position += count * sizeof(value_t);
+        return std::fwrite(std::addressof(*std::begin(range)), sizeof(value_t), count, file) == count;
+    }
+
+    template<class T>
+    auto section_fits(snapshot_header const& header, std::uint64_t offset, std::uint64_t count) noexcept -> bool {
+        return offset % alignof(T) == 0 and offset <= header.file_size and
+               count <= (header.file_size - offset) / sizeof(T);
+    }
+
+    // Syncs the directory holding @p path , so a rename into it survives a crash.
+    // @p buffer holds at least the length of @p path plus one.
+    inline auto sync_directory(char const* path, char* buffer) noexcept -> bool {
+        const char* slash = std::strrchr(path, '/');
+        if (slash == nullptr) {
+            std::strcpy(buffer, ".");
+        } else {
+            const auto length = slash == path ? 1 : static_cast<std::size_t>(slash - path);
+            std::memcpy(buffer, path, length);
+            buffer[length] = '\0';
+        }
+
+        const int directory = ::open(buffer, O_RDONLY | O_DIRECTORY);
+        if (directory == -1) {
+            return false;
+        }
+        const bool synced = ::fsync(directory) == 0;
+        return ::close(directory) == 0 and synced;
+    }
+}
+
+/**
+ * @brief Read-only view of an associated_collection mapped from a snapshot file.
+ * 
+ * Opening only validates the header, the arrays are used straight from the
+ * mapping with no copies. Call to_collection() to promote it to a mutable copy.
+ * 
+ * @tparam AssociatedCollection the associated_collection type the snapshot was written from.
+ */
+template<class AssociatedCollection>
+class associated_snapshot {
+public:
+    using collection_type   = AssociatedCollection;
+    using key_type          = typename collection_type::key_type;
+    using foreign_key_type  = typename collection_type::foreign_key_type;
+    using value_type        = typename collection_type::value_type;
+    using const_reference   = typename collection_type::const_reference;
+    using avalue_type       = typename collection_type::avalue_type;
+    using cvalue_type       = typename collection_type::contributors_type::value_type;
+    using size_type         = std::size_t;
+    using const_iterator    = value_type const*;
+    using const_aiterator   = avalue_type const*;
+
+    static_assert(calgo::is_memcpy_copyable<value_type>,  "Elements must be memcpy copyable to be snapshotted.");
+    static_assert(calgo::is_memcpy_copyable<avalue_type>, "Associations must be memcpy copyable to be snapshotted.");
+    static_assert(calgo::is_memcpy_copyable<cvalue_type>, "Contributors must be memcpy copyable to be snapshotted.");
+
+private:
+
+    void const*     mapping_{ nullptr };
+    std::size_t     mapped_size_{ 0 };
+    snapshot_header header_{};
+
+    associated_snapshot(void const* mapping, std::size_t mapped_size) noexcept
+        : mapping_{ mapping }, mapped_size_{ mapped_size } {
+        std::memcpy(&header_, mapping_, sizeof(header_));
+    }
+
+    template<class T>
+    auto section(std::uint64_t offset, std::uint64_t count) const noexcept -> std::span<T const> {
+        if (count == 0) return {};
+        return { reinterpret_cast<T const*>(static_cast<char const*>(mapping_) + offset), static_cast<std::size_t>(count) };
+    }
+
+public:
+
+    associated_snapshot(associated_snapshot const&) = delete;
+    associated_snapshot& operator=(associated_snapshot const&) = delete;
+
+    associated_snapshot(associated_snapshot&& other) noexcept
+        : mapping_{ std::exchange(other.mapping_, nullptr) }
+        , mapped_size_{ std::exchange(other.mapped_size_, 0) }
+        , header_{ other.header_ } { }
+
+    associated_snapshot& operator=(associated_snapshot&& other) noexcept {
+        std::swap(mapping_, other.mapping_);
+        std::swap(mapped_size_, other.mapped_size_);
+        std::swap(header_, other.header_);
+        return *this;
+    }
+
+    ~associated_snapshot() noexcept {
+        if (mapping_ != nullptr) {
+            ::munmap(const_cast<void*>(mapping_), mapped_size_);
+        }
+    }
+
+    /**
+     * @brief Maps the snapshot at @p path read-only.
+     * 
+     * @param path file written by write_snapshot.
+     * @return std::nullopt if the file can't be mapped, or its header doesn't match
+     * this version, byte order, collection type or element, key and contributor sizes.
+     */
+    static auto open(char const* path) noexcept -> std::optional<associated_snapshot> {
+        const int fd = ::open(path, O_RDONLY | O_CLOEXEC);
+        if (fd < 0) {
+            return std::nullopt;
+        }
+
+        struct stat status{};
+        if (::fstat(fd, &status) != 0 or static_cast<std::uint64_t>(status.st_size) < sizeof(snapshot_header)) {
+            ::close(fd);
+            return std::nullopt;
+        }
+
+        const auto size    = static_cast<std::size_t>(status.st_size);
+        void*      mapping = ::mmap(nullptr, size, PROT_READ, MAP_SHARED, fd, 0);
+        ::close(fd);
+        if (mapping == MAP_FAILED) {
+            return std::nullopt;
+        }
+
+        associated_snapshot snapshot{ mapping, size };
+        if (not snapshot.valid()) {
+            return std::nullopt;
+        }
+        return snapshot;
+    }
+
+    snapshot_header const&         header()       const noexcept { return header_; }
+    std::span<value_type  const>   collection()   const noexcept { return section<value_type>(header_.element_offset, header_.element_count); }
+    std::span<avalue_type const>   associations() const noexcept { return section<avalue_type>(header_.association_offset, header_.association_count); }
+    std::span<cvalue_type const>   contributors() const noexcept { return section<cvalue_type>(header_.contributor_offset, header_.contributor_count); }
+    size_type                      size()         const noexcept { return collection().size(); }
+    const_iterator                 begin()        const noexcept { return collection().data(); }
+    const_iterator                 end()          const noexcept { return collection().data() + collection().size(); }
+
+    /**
+     * @brief Range of the associations of @p key.
+     */
+    auto equal_range(key_type const& key) const noexcept -> std::pair<const_aiterator, const_aiterator> {
+        const auto all = associations();
+        return std::equal_range(all.data(), all.data() + all.size(), key, calgo::overload{
+            [](avalue_type const& a, key_type const& k) { return calgo::key(a) < k; },
+            [](key_type const& k, avalue_type const& a) { return k < calgo::key(a); }
+        });
+    }
+
+    /**
+     * @brief Visits every element associated with the @p foreign_key.
+     * 
+     * @tparam UnaryOperation Callable taking const_reference.
+     */
+    template<class UnaryOperation>
+    auto visit(foreign_key_type const& foreign_key, UnaryOperation operation) const noexcept -> void {
+        auto elements = collection();
+        auto associated = associations();
+        calgo::set_intersection_merge(elements, associated, operation, calgo::overload{
+            [&](const_reference a, avalue_type const& b) {
+                return not (calgo::value(b) == foreign_key and a == calgo::key(b)) and a < calgo::key(b);
+            },
+            [&](avalue_type const& b, const_reference a) {
+                return not (calgo::value(b) == foreign_key and a == calgo::key(b)) and not (a < calgo::key(b));
+            }
+        });
+    }
+
+    /**
+     * @brief Promotes the snapshot to a mutable associated_collection, one copy of each array.
+     * 
+     * @param allocator the promoted collection allocates from.
+     */
+    auto to_collection(typename collection_type::allocator_type const& allocator = {}) const -> collection_type {
+        return collection_type{ boost::container::ordered_range, collection(), associations(), contributors(), allocator };
+    }
+
+private:
+
+    auto valid() const noexcept -> bool {
+        return header_.magic            == snapshot_header::magic_value     and
+               header_.version          == snapshot_header::current_version and
+               header_.endian           == snapshot_header::endian_value    and
+               header_.type_hash        == snapshot_detail::type_hash<collection_type>() and
+               header_.element_size     == sizeof(value_type)               and
+               header_.association_size == sizeof(avalue_type)              and
+               header_.contributor_size == sizeof(cvalue_type)              and
+               header_.file_size        == mapped_size_                     and
+               snapshot_detail::section_fits<value_type>(header_, header_.element_offset, header_.element_count)             and
+               snapshot_detail::section_fits<avalue_type>(header_, header_.association_offset, header_.association_count) and
+               snapshot_detail::section_fits<cvalue_type>(header_, header_.contributor_offset, header_.contributor_count);
+    }
+};
+
+/**
+ * @brief Writes the sorted arrays of @p collection into a snapshot file at @p path.
+ * 
+ * The snapshot is written to a fresh temporary file next to @p path, synced to disk and
+ * renamed over @p path, and the directory synced, so a reader or a crash mid-write only ever
+ * sees the old file or the new one.
+ * 
+ * @tparam AssociatedCollection associated_collection with memcpy copyable elements, keys and contributors.
+ * @param collection collection to write.
+ * @param path file to create or replace.
+ * @return false if the file could not be fully written, @p path is then left as it was,
+ * or if the directory could not be synced after the rename, with @p path already replaced.
+ */
+template<class AssociatedCollection>
+auto write_snapshot(AssociatedCollection const& collection, char const* path) noexcept -> bool {
+    using snapshot_t = associated_snapshot<AssociatedCollection>;
+
+    snapshot_header header{};
+    header.magic              = snapshot_header::magic_value;
+    header.version            = snapshot_header::current_version;
+    header.endian             = snapshot_header::endian_value;
+    header.element_size       = sizeof(typename snapshot_t::value_type);
+    header.association_size   = sizeof(typename snapshot_t::avalue_type);
+    header.contributor_size   = sizeof(typename snapshot_t::cvalue_type);
+    header.type_hash          = snapshot_detail::type_hash<AssociatedCollection>();
+    header.element_count      = collection.size();
+    header.association_count  = collection.associations().size();
+    header.contributor_count  = collection.contributors().size();
+    header.element_offset     = snapshot_detail::align_up(sizeof(header));
+    header.association_offset = snapshot_detail::align_up(header.element_offset + header.element_count * header.element_size);
+    header.contributor_offset = snapshot_detail::align_up(header.association_offset + header.association_count * header.association_size);
+    header.file_size          = header.contributor_offset + header.contributor_count * header.contributor_size;
+
+    // mkstemp replaces the X's with a name no one else holds, next to path so the rename stays on one file system.
+    static constexpr char suffix[] = ".XXXXXX";
+    const auto path_length = std::strlen(path);
+    std::unique_ptr<char[]> temporary_path{ new (std::nothrow) char[path_length + sizeof(suffix)] };
+    if (not temporary_path) {
+        return false;
+    }
+    std::memcpy(temporary_path.get(), path, path_length);
+    std::memcpy(temporary_path.get() + path_length, suffix, sizeof(suffix));
+
+    const int descriptor = ::mkstemp(temporary_path.get());
+    if (descriptor == -1) {
+        return false;
+    }
+    // mkstemp creates the file readable by its owner only, it gets the mode of the file replaced.
+    struct stat replaced;
+    const mode_t mode = ::stat(path, &replaced) == 0 ? replaced.st_mode & 07777 : 0644;
+
+    std::unique_ptr<std::FILE, int(*)(std::FILE*)> file{ ::fdopen(descriptor, "wb"), &std::fclose };
+    if (not file) {
+        ::close(descriptor);
+        std::remove(temporary_path.get());
+        return false;
+    }
+
+    std::uint64_t position = sizeof(header);
+    const bool written = ::fchmod(descriptor, mode) == 0                                                                    and
+                         std::fwrite(&header, sizeof(header), 1, file.get()) == 1                                           and
+                         snapshot_detail::write_section(file.get(), position, header.element_offset, collection)            and
+                         snapshot_detail::write_section(file.get(), position, header.association_offset, collection.associations()) and
+                         snapshot_detail::write_section(file.get(), position, header.contributor_offset, collection.contributors()) and
+                         std::fflush(file.get()) == 0                                                                       and
+                         ::fsync(descriptor) == 0;
+
+    if (not (std::fclose(file.release()) == 0 and written and std::rename(temporary_path.get(), path) == 0)) {
+        std::remove(temporary_path.get());
+        return false;
+    }
+    return snapshot_detail::sync_directory(path, temporary_path.get());
+}
@@ -0,0 +1,148 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <span>
+#include <type_traits>
+#include <variant>
+#include <vector>
+#include "container_algo.hpp"
+
+/**
+ * @brief Append-only log of the mutations of an associated_collection.
+ *
+ * Every change gets a sequence number, its cursor. Consumers remember the
+ * cursor they stopped at, read everything recorded since(), and the owner
+ * drops the prefix every consumer has seen with discard_until().
+ *
+ * @tparam Element element type of the collection.
+ * @tparam Key key type of the collection.
+ * @tparam Foreign_key foreign key type of the collection.
+ * @tparam Allocator rebound for the storage of the changes.
+ */
+template<class Element, class Key, class Foreign_key, class Allocator = std::allocator<Element>>
+class change_log {
+public:
+    struct element_inserted    { Element element; };
+    struct element_erased      { Key key; };
+    struct association_added   { Key key; Foreign_key foreign_key; };
+    struct association_removed { Key key; Foreign_key foreign_key; };
+
+    using change_type    = std::variant<element_inserted, element_erased, association_added, association_removed>;
+    using value_type     = change_type;
+    using cursor_type    = std::uint64_t;
+    using allocator_type = typename std::allocator_traits<Allocator>::template rebind_alloc<change_type>;
+    using changes_type   = std::vector<change_type, allocator_type>;
+
+private:
+
+    changes_type changes_;
+    cursor_type  first_{ 0 };
+
+public:
+
+    change_log() = default;
+    explicit change_log(allocator_type const& allocator) : changes_(allocator) { }
+
+    cursor_type begin_cursor() const noexcept { return first_; }
+    cursor_type end_cursor()   const noexcept { return first_ + changes_.size(); }
+    bool        empty()        const noexcept { return changes_.empty(); }
+    std::size_t size()         const noexcept { return changes_.size(); }
+    std::size_t capacity()     const noexcept { return changes_.capacity(); }
+    void        shrink_to_fit()      noexcept { changes_.shrink_to_fit(); }
+
+    template<class Change>
+    void record(Change&& change) noexcept {
+        changes_.emplace_back(std::forward<Change>(change));
+    }
+
+    /**
+     * @brief Changes recorded from @p cursor up to end_cursor().
+     *
+     * A cursor older than begin_cursor() only gets the changes still kept,
+     * compare it against begin_cursor() to detect that a consumer fell behind.
+     */
+    auto since(cursor_type cursor) const noexcept -> std::span<change_type const> {
+        const auto from = std::clamp(cursor, first_, end_cursor()) - first_;
+        return { changes_.data() + from, changes_.size() - from };
+    }
+
+    /**
+     * @brief Drops every change before @p cursor, once all consumers have read past it.
+     */
+    void discard_until(cursor_type cursor) noexcept {
+        const auto until = std::clamp(cursor, first_, end_cursor()) - first_;
+        changes_.erase(std::begin(changes_), std::next(std::begin(changes_), static_cast<std::ptrdiff_t>(until)));
+        first_ += until;
+    }
+
+    /**
+     * @brief Appends @p changes to @p out as a one byte tag followed by the raw bytes of each field.
+     */
+    template<class Bytes>
+    static void serialize(std::span<change_type const> changes, Bytes& out) {
+        static_assert(calgo::is_memcpy_copyable<Element> and calgo::is_memcpy_copyable<Key> and calgo::is_memcpy_copyable<Foreign_key>,
+                      "Elements and keys must be memcpy copyable to be serialized.");
+
+        for (auto const& change : changes) {
+            out.push_back(static_cast<std::byte>(change.index()));
+            std::visit(calgo::overload{
+                [&](element_inserted const& c)    { write(out, c.element); },
+                [&](element_erased const& c)      { write(out, c.key); },
+                [&](association_added const& c)   { write(out, c.key); write(out, c.foreign_key); },
+                [&](association_removed const& c) { write(out, c.key); write(out, c.foreign_key); }
+            }, change);
+        }
+    }
+
+    /**
+     * @brief Reads changes written by serialize() from @p bytes and appends them to @p out.
+     *
+     * @return false if @p bytes is truncated or holds an unknown tag, the changes read before it are kept.
+     */
+    template<class Changes>
+    static auto deserialize(std::span<std::byte const> bytes, Changes& out) -> bool {
+        static_assert(std::is_default_constructible_v<Element> and std::is_default_constructible_v<Key> and std::is_default_constructible_v<Foreign_key>,
+                      "Elements and keys must be default constructible to be deserialized.");
+
+        while (not bytes.empty()) {
+            const auto tag = static_cast<std::size_t>(bytes.front());
+            bytes = bytes.subspan(1);
+
+            bool read_all = false;
+            switch (tag) {
+                case 0: { element_inserted c{};    read_all = read(bytes, c.element);                              if (read_all) out.push_back(c); break; }
+                case 1: { element_erased c{};      read_all = read(bytes, c.key);                                  if (read_all) out.push_back(c); break; }
+                case 2: { association_added c{};   read_all = read(bytes, c.key) and read(bytes, c.foreign_key);   if (read_all) out.push_back(c); break; }
+                case 3: { association_removed c{}; read_all = read(bytes, c.key) and read(bytes, c.foreign_key);   if (read_all) out.push_back(c); break; }
+                default: break;
+            }
+
+            if (not read_all) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+private:
+
+    template<class Bytes, class T>
+    static void write(Bytes& out, T const& value) {
+        auto const* first = reinterpret_cast<std::byte const*>(std::addressof(value));
+        out.insert(std::end(out), first, first + sizeof(T));
+    }
+
+    template<class T>
+    static auto read(std::span<std::byte const>& bytes, T& value) noexcept -> bool {
+        if (bytes.size() < sizeof(T)) {
+            return false;
+        }
+        std::memcpy(static_cast<void*>(std::addressof(value)), bytes.data(), sizeof(T));
+        bytes = bytes.subspan(sizeof(T));
+        return true;
+    }
+};
@@ -0,0 +1,313 @@
+#pragma once
+
+#include <climits>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <iterator>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#include "container_algo.hpp"
+
+// Hash based counterparts of the calgo algorithms that need sorted input.
+//
+// erase_duplicates, unique_copy and the std set operations only see adjacent or ordered
+// elements, these find equal elements anywhere in the range in expected O(n), through an
+// open addressing table of positions sized from the input. Elements need a hash and an
+// equality, calgo::hash covers std::hash types and tuples and pairs of them.
+
+namespace calgo {
+
+    /**
+     * @brief std::hash, extended member wise to std::tuple and std::pair.
+     */
+    struct hash {
+        template<class T>
+        auto operator()(T const& value) const noexcept -> std::size_t {
+            if constexpr (requires { std::tuple_size<T>::value; }) {
+                return std::apply([this](auto const&... members) {
+                    std::size_t seed = 0;
+                    ((seed ^= (*this)(members) + 0x9e3779b97f4a7c15 + (seed << 6) + (seed >> 2)), ...);
+                    return seed;
+                }, value);
+            } else {
+                return std::hash<T>{}(value);
+            }
+        }
+    };
+
+    /**
+     * @brief Order of the elements an unordered algorithm keeps.
+     */
+    enum class element_order {
+        any,              ///< the order moving the fewest elements leaves.
+        first_occurrence  ///< the order the first of each equal elements came in.
+    };
+
+    namespace hash_detail {
+
+        /**
+         * Open addressing table of positions into one or two ranges, linear probing,
+         * at most half full. A slot holds position + 1, 0 when empty, and its highest
+         * bit is a flag left to the algorithm.
+         */
+        template<class Index>
+        class position_table {
+        public:
+            static constexpr Index flag = Index{ 1 } << (sizeof(Index) * CHAR_BIT - 1);
+
+            explicit position_table(std::size_t expected) {
+                std::size_t capacity = 16;
+                int bits = 4;
+                while (capacity < 2 * expected) {
+                    capacity *= 2;
+                    ++bits;
+                }
+                shift_ = 64 - bits;
+                mask_  = capacity - 1;
+                slots_.resize(capacity);
+            }
+
+            // The slot whose entry matches(entry), or the empty slot where it belongs.
+            template<class Matches>
+            auto probe(std::size_t hash, Matches matches) noexcept -> Index& {
+                // Fibonacci hashing spreads std::hash's identity on integers over the table.
+                auto i = static_cast<std::size_t>((static_cast<std::uint64_t>(hash) * 0x9e3779b97f4a7c15) >> shift_);
+                for (;; i = (i + 1) & mask_) {
+                    auto& slot = slots_[i];
+                    if (slot == 0 or matches(slot)) {
+                        return slot;
+                    }
+                }
+            }
+
+            static constexpr auto entry(std::size_t position, bool flagged = false) noexcept -> Index {
+                return static_cast<Index>(position + 1) | (flagged ? flag : Index{ 0 });
+            }
+
+            static constexpr auto position(Index slot) noexcept -> std::size_t {
+                return static_cast<std::size_t>(slot & ~flag) - 1;
+            }
+
+            static constexpr auto flagged(Index slot) noexcept -> bool {
+                return (slot & flag) != 0;
+            }
+
+        private:
+            int                shift_{ 60 };
+            std::size_t        mask_{ 15 };
+            std::vector<Index> slots_;
+        };
+
+        // Calls function(table) with a table for @p expected positions, 32 bit slots when they fit.
+        template<class Function>
+        auto with_table(std::size_t expected, Function function) {
+            if (expected < position_table<std::uint32_t>::flag - 1) {
+                return function(position_table<std::uint32_t>(expected));
+            }
+            return function(position_table<std::uint64_t>(expected));
+        }
+
+        template<class Iterable>
+        constexpr void check_random_access() noexcept {
+            static_assert(is_iterable<Iterable>, "Must be iterable [have begin() and end() functions.]");
+            static_assert(std::random_access_iterator<decltype(std::begin(std::declval<Iterable&>()))>,
+                          "The table holds positions, the range must be random access.");
+        }
+    }
+
+    /**
+     * @brief Erases the elements of @p container equal to an earlier one, wherever they are.
+     *
+     * With element_order::any a duplicate is overwritten by the last unchecked element,
+     * moving one element per duplicate instead of every element after the first duplicate.
+     * It only pays off when duplicates are rare and elements are expensive to move:
+     * on 1M strings, 170ms against 200ms without duplicates, 327ms against 309ms with half.
+     *
+     * @tparam Container STL like container with random access iterators.
+     * @param container mutable reference to a container.
+     * @param order order of the elements left in @p container.
+     * @param hash hash of the container's value type, consistent with @p equal .
+     * @param equal equality of two elements.
+     *
+     * complexity : expected O(n).
+     */
+    template<class Container, class Hash = calgo::hash, class KeyEqual = std::equal_to<>>
+    auto erase_duplicates_unordered(Container& container, element_order order = element_order::first_occurrence,
+                                    Hash hash = {}, KeyEqual equal = {}) noexcept -> void {
+        static_assert(is_container<Container>, "Must be an STL like Container. ");
+        hash_detail::check_random_access<Container>();
+        const auto first = std::begin(container);
+        const auto size  = static_cast<std::size_t>(calgo::distance(container));
+
+        const auto kept = hash_detail::with_table(size, [&](auto table) -> std::size_t {
+            const auto find = [&](auto const& element) -> auto& {
+                return table.probe(hash(element), [&](auto entry) { return equal(first[table.position(entry)], element); });
+            };
+
+            if (order == element_order::first_occurrence) {
+                std::size_t kept = 0;
+                for (std::size_t i = 0; i != size; ++i) {
+                    auto& slot = find(first[i]);
+                    if (slot == 0) {
+                        if (kept != i) {
+                            first[kept] = std::move(first[i]);
+                        }
+                        slot = table.entry(kept++);
+                    }
+                }
+                return kept;
+            }
+
+            std::size_t i = 0, last = size;
+            while (i != last) {
+                auto& slot = find(first[i]);
+                if (slot == 0) {
+                    slot = table.entry(i++);
+                } else if (i != --last) {
+                    first[i] = std::move(first[last]);
+                }
+            }
+            return last;
+        });
+        erase_to_end(container, std::next(first, static_cast<std::ptrdiff_t>(kept)));
+    }
+
+    /**
+     * @brief Copies the first of every group of equal elements of @p container to @p out , in order.
+     *
+     * @tparam Container STL like container with random access iterators.
+     * @return @p out advanced past the last copied element.
+     *
+     * complexity : expected O(n).
+     */
+    template<class Container, class Out, class Hash = calgo::hash, class KeyEqual = std::equal_to<>>
+    auto unique_unordered_copy(Container const& container, Out out, Hash hash = {}, KeyEqual equal = {}) noexcept -> Out {
+        hash_detail::check_random_access<Container const>();
+        const auto first = std::begin(container);
+        const auto size  = static_cast<std::size_t>(calgo::distance(container));
+
+        return hash_detail::with_table(size, [&](auto table) -> Out {
+            for (std::size_t i = 0; i != size; ++i) {
+                auto& slot = table.probe(hash(first[i]), [&](auto entry) { return equal(first[table.position(entry)], first[i]); });
+                if (slot == 0) {
+                    slot = table.entry(i);
+                    *out++ = first[i];
+                }
+            }
+            return out;
+        });
+    }
+
+    /**
+     * @brief Copies to @p out the elements of @p container found in @p container2 , neither needs
+     * to be sorted. Each element is copied once, in the order of its first occurrence in @p container .
+     *
+     * The table is built over the smaller of the two ranges.
+     *
+     * @return @p out advanced past the last copied element.
+     *
+     * complexity : expected O(n + m).
+     */
+    template<class Container, class Container2, class Out, class Hash = calgo::hash, class KeyEqual = std::equal_to<>>
+    auto set_intersection_unordered(Container const& container, Container2 const& container2, Out out,
+                                    Hash hash = {}, KeyEqual equal = {}) noexcept -> Out {
+        hash_detail::check_random_access<Container const>();
+        hash_detail::check_random_access<Container2 const>();
+        const auto first  = std::begin(container);
+        const auto first2 = std::begin(container2);
+        const auto size   = static_cast<std::size_t>(calgo::distance(container));
+        const auto size2  = static_cast<std::size_t>(calgo::distance(container2));
+
+        if (size2 <= size) {
+            // Table over container2, an entry is flagged once its element has been copied.
+            return hash_detail::with_table(size2, [&](auto table) -> Out {
+                for (std::size_t i = 0; i != size2; ++i) {
+                    auto& slot = table.probe(hash(first2[i]), [&](auto entry) { return equal(first2[table.position(entry)], first2[i]); });
+                    if (slot == 0) {
+                        slot = table.entry(i);
+                    }
+                }
+                for (std::size_t i = 0; i != size; ++i) {
+                    auto& slot = table.probe(hash(first[i]), [&](auto entry) { return equal(first2[table.position(entry)], first[i]); });
+                    if (slot != 0 and not table.flagged(slot)) {
+                        slot |= table.flag;
+                        *out++ = first[i];
+                    }
+                }
+                return out;
+            });
+        }
+
+        // Table over container, flagged when found in container2, then copied in container's order.
+        return hash_detail::with_table(size, [&](auto table) -> Out {
+            const auto find = [&](auto const& element) -> auto& {
+                return table.probe(hash(element), [&](auto entry) { return equal(first[table.position(entry)], element); });
+            };
+            for (std::size_t i = 0; i != size; ++i) {
+                auto& slot = find(first[i]);
+                if (slot == 0) {
+                    slot = table.entry(i);
+                }
+            }
+            for (std::size_t i = 0; i != size2; ++i) {
+                auto& slot = find(first2[i]);
+                if (slot != 0) {
+                    slot |= table.flag;
+                }
+            }
+            for (std::size_t i = 0; i != size; ++i) {
+                auto& slot = find(first[i]);
+                if (table.flagged(slot) and table.position(slot) == i) {
+                    *out++ = first[i];
+                }
+            }
+            return out;
+        });
+    }
+
+    /**
+     * @brief Copies to @p out the elements of @p container not found in @p container2 , neither needs
+     * to be sorted. Each element is copied once, in the order of its first occurrence in @p container .
+     *
+     * @return @p out advanced past the last copied element.
+     *
+     * complexity : expected O(n + m).
+     */
+    template<class Container, class Container2, class Out, class Hash = calgo::hash, class KeyEqual = std::equal_to<>>
+    auto set_difference_unordered(Container const& container, Container2 const& container2, Out out,
+                                  Hash hash = {}, KeyEqual equal = {}) noexcept -> Out {
+        hash_detail::check_random_access<Container const>();
+        hash_detail::check_random_access<Container2 const>();
+        const auto first  = std::begin(container);
+        const auto first2 = std::begin(container2);
+        const auto size   = static_cast<std::size_t>(calgo::distance(container));
+        const auto size2  = static_cast<std::size_t>(calgo::distance(container2));
+
+        // One table for both: container2's elements, then container's copied ones, flagged.
+        return hash_detail::with_table(size + size2, [&](auto table) -> Out {
+            const auto find = [&](auto const& element) -> auto& {
+                return table.probe(hash(element), [&](auto entry) {
+                    return table.flagged(entry) ? equal(first[table.position(entry)], element)
+                                                : equal(first2[table.position(entry)], element);
+                });
+            };
+            for (std::size_t i = 0; i != size2; ++i) {
+                auto& slot = find(first2[i]);
+                if (slot == 0) {
+                    slot = table.entry(i);
+                }
+            }
+            for (std::size_t i = 0; i != size; ++i) {
+                auto& slot = find(first[i]);
+                if (slot == 0) {
+                    slot = table.entry(i, true);
+                    *out++ = first[i];
+                }
+            }
+            return out;
+        });
+    }
+}
@@ -0,0 +1,147 @@
+#pragma once
+
+#include <bit>
+#include <climits>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+// Order preserving packing of keys into unsigned integers:
+// a < b  <=>  pack_key(a) < pack_key(b), so sorting and searching can run on plain integers.
+
+namespace calgo {
+#if defined(__SIZEOF_INT128__)
+    using uint128_t = unsigned __int128;
+#endif
+
+    /**
+     * @brief Smallest unsigned integer holding @p Bits bits, void when there is none.
+     */
+    template<std::size_t Bits>
+    using packed_integer_t = std::conditional_t<(Bits <= 32), std::uint32_t,
+                             std::conditional_t<(Bits <= 64), std::uint64_t,
+#if defined(__SIZEOF_INT128__)
+                             std::conditional_t<(Bits <= 128), uint128_t, void>
+#else
+                             void
+#endif
+                             >>;
+
+    /**
+     * @brief Primary template for types that can't be packed.
+     *
+     * Specializations provide bits, the width of the packed value, and
+     * pack(value) returning it in the low bits of a packed_integer_t<bits>.
+     */
+    template<class T, class = void>
+    struct key_packing {
+        static constexpr bool        packable = false;
+        static constexpr std::size_t bits     = 0;
+    };
+
+    // Unsigned integers and bool map onto themselves, signed ones get their sign bit flipped.
+    template<class T>
+    struct key_packing<T, std::enable_if_t<std::is_integral_v<T>>> {
+        static constexpr bool        packable = true;
+        static constexpr std::size_t bits     = std::is_same_v<T, bool> ? 1 : sizeof(T) * CHAR_BIT;
+        using unsigned_type = std::make_unsigned_t<std::conditional_t<std::is_same_v<T, bool>, unsigned char, T>>;
+
+        static constexpr auto pack(T value) noexcept -> packed_integer_t<bits> {
+            auto u = static_cast<unsigned_type>(value);
+            if constexpr (std::is_signed_v<T>) {
+                u ^= unsigned_type{ 1 } << (bits - 1);
+            }
+            return u;
+        }
+    };
+
+    template<class T>
+    struct key_packing<T, std::enable_if_t<std::is_enum_v<T>>> {
+        using underlying_packing = key_packing<std::underlying_type_t<T>>;
+        static constexpr bool        packable = true;
+        static constexpr std::size_t bits     = underlying_packing::bits;
+
+        static constexpr auto pack(T value) noexcept -> packed_integer_t<bits> {
+            return underlying_packing::pack(static_cast<std::underlying_type_t<T>>(value));
+        }
+    };
+
+    // IEEE floats: positives get the sign bit set, negatives get every bit flipped.
+    // -0.0 packs below +0.0 and NaNs pack above every number, unlike operator<.
+    template<class T>
+    struct key_packing<T, std::enable_if_t<std::is_floating_point_v<T> and std::numeric_limits<T>::is_iec559 and
+                                           (sizeof(T) == sizeof(std::uint32_t) or sizeof(T) == sizeof(std::uint64_t))>> {
+        static constexpr bool        packable = true;
+        static constexpr std::size_t bits     = sizeof(T) * CHAR_BIT;
+        using unsigned_type = std::conditional_t<sizeof(T) == sizeof(std::uint32_t), std::uint32_t, std::uint64_t>;
+
+        static constexpr auto pack(T value) noexcept -> packed_integer_t<bits> {
+            const auto u    = std::bit_cast<unsigned_type>(value);
+            const auto sign = unsigned_type{ 1 } << (bits - 1);
+            return (u & sign) ? ~u : (u | sign);
+        }
+    };
+
+    namespace packing_detail {
+        template<class... Ts>
+        constexpr bool all_packable = (key_packing<Ts>::packable and ...);
+
+        template<class... Ts>
+        constexpr std::size_t total_bits = (key_packing<Ts>::bits + ... + 0);
+
+        // Shifts @p packed left to make room for @p member, a full width member is the only one.
+        template<std::size_t Bits, class Packed, class Member>
+        constexpr auto shift_in(Packed packed, Member member) noexcept -> Packed {
+            if constexpr (Bits >= sizeof(Packed) * CHAR_BIT) {
+                return static_cast<Packed>(member);
+            } else {
+                return static_cast<Packed>((packed << Bits) | static_cast<Packed>(member));
+            }
+        }
+
+        // Lexicographic: the first member lands in the highest bits.
+        template<class Packed, class Tuple, std::size_t... Is>
+        constexpr auto pack_members(Tuple const& t, std::index_sequence<Is...>) noexcept -> Packed {
+            Packed packed{ 0 };
+            ((packed = shift_in<key_packing<std::tuple_element_t<Is, Tuple>>::bits>(
+                       packed, key_packing<std::tuple_element_t<Is, Tuple>>::pack(std::get<Is>(t)))), ...);
+            return packed;
+        }
+
+        template<class Tuple, class... Ts>
+        struct tuple_packing {
+            static constexpr bool        packable = all_packable<Ts...> and not std::is_void_v<packed_integer_t<total_bits<Ts...>>>;
+            static constexpr std::size_t bits     = total_bits<Ts...>;
+
+            static constexpr auto pack(Tuple const& t) noexcept -> packed_integer_t<bits> {
+                return pack_members<packed_integer_t<bits>>(t, std::index_sequence_for<Ts...>{});
+            }
+        };
+    }
+
+    template<class... Ts>
+    struct key_packing<std::tuple<Ts...>, std::enable_if_t<packing_detail::all_packable<Ts...>>>
+        : packing_detail::tuple_packing<std::tuple<Ts...>, Ts...> { };
+
+    template<class T1, class T2>
+    struct key_packing<std::pair<T1, T2>, std::enable_if_t<packing_detail::all_packable<T1, T2>>>
+        : packing_detail::tuple_packing<std::pair<T1, T2>, T1, T2> { };
+
+    template<class T>
+    constexpr bool is_packable = key_packing<std::remove_cv_t<T>>::packable;
+
+    template<class T>
+    using packed_key_t = packed_integer_t<key_packing<std::remove_cv_t<T>>::bits>;
+
+    /**
+     * @brief Packs @p value into an unsigned integer with the same ordering as operator<.
+     */
+    template<class T>
+    constexpr auto pack_key(T const& value) noexcept -> packed_key_t<T> {
+        static_assert(is_packable<T>, "Key must be packable: integers, enums, floats, or tuples and pairs of them within 128 bits.");
+        return key_packing<std::remove_cv_t<T>>::pack(value);
+    }
+}
@@ -0,0 +1,454 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <execution>
+#include <functional>
+#include <iterator>
+#include <numeric>
+#include <thread>
+#include <type_traits>
+#include <vector>
+#include "container_algo.hpp"
+#include "task_queue.hpp"
+
+// Parallel overloads of the calgo algorithms.
+//
+// The first argument picks how they run: a standard execution policy forwards to the
+// standard parallel algorithms (libstdc++ needs TBB linked for those), a task_system splits
+// the range into one part per worker plus the caller and blocks until every part is done.
+// Like task_system::fork_join, the task_system overloads must not be called from inside one
+// of its own tasks, and the callables they take are called concurrently.
+
+namespace calgo {
+
+    template<class T>
+    concept execution_policy = std::is_execution_policy_v<std::remove_cvref_t<T>>;
+
+    namespace parallel_detail {
+
+        // Ranges shorter than this per part aren't worth waking a worker for.
+        constexpr std::size_t min_part_size = 4096;
+
+        inline auto part_count(task_system const& tasks, std::size_t size) noexcept -> unsigned {
+            return static_cast<unsigned>(std::clamp<std::size_t>(size / min_part_size, 1, tasks.concurrency() + 1));
+        }
+
+        // Start of part @p part of @p parts over the @p size elements from @p first.
+        template<class Iterator>
+        auto part_begin(Iterator first, std::size_t size, unsigned parts, unsigned part) noexcept -> Iterator {
+            return std::next(first, static_cast<std::ptrdiff_t>(size * part / parts));
+        }
+
+        // Stable merge of the sorted [a, a_end) and [b, b_end) into out, split in @p pieces merged in parallel.
+        // Each piece boundary is placed on the longer run and searched for in the other one.
+        template<class Iterator, class Out, class Compare>
+        void merge(task_system& tasks, unsigned pieces, Iterator a, Iterator a_end, Iterator b, Iterator b_end, Out out, Compare& compare) noexcept {
+            const auto a_size = static_cast<std::size_t>(std::distance(a, a_end));
+            const auto b_size = static_cast<std::size_t>(std::distance(b, b_end));
+            // All the splits are searched before any piece moves its elements out.
+            std::vector<std::pair<Iterator, Iterator>> splits(pieces + 1);
+            splits.front() = { a, b };
+            splits.back()  = { a_end, b_end };
+            for (unsigned piece = 1; piece < pieces; ++piece) {
+                if (a_size >= b_size) {
+                    auto at = part_begin(a, a_size, pieces, piece);
+                    splits[piece] = { at, std::lower_bound(b, b_end, *at, compare) };
+                } else {
+                    auto at = part_begin(b, b_size, pieces, piece);
+                    splits[piece] = { std::upper_bound(a, a_end, *at, compare), at };
+                }
+            }
+
+            // std::merge over move iterators would hand the comparison rvalues.
+            const auto merge_piece = [&](unsigned piece) {
+                auto [a_first, b_first] = splits[piece];
+                const auto [a_last, b_last] = splits[piece + 1];
+                auto to = std::next(out, std::distance(a, a_first) + std::distance(b, b_first));
+                while (a_first != a_last and b_first != b_last) {
+                    *to++ = compare(*b_first, *a_first) ? std::move(*b_first++) : std::move(*a_first++);
+                }
+                std::move(b_first, b_last, std::move(a_first, a_last, to));
+            };
+
+            if (pieces < 2) {
+                merge_piece(0);
+            } else {
+                tasks.fork_join(pieces, merge_piece);
+            }
+        }
+    }
+
+    /**
+     * @brief Parallel merge sort of @p container : each part is sorted with std::sort,
+     * then sorted runs are merged pairwise, every merge itself split across the workers.
+     *
+     * @tparam Container STL like container with random access iterators.
+     * @tparam BinaryPredicate strict weak ordering of the container's value type.
+     * @param tasks pool the parts run on.
+     * @param container mutable reference to a container.
+     * @param binary_predicate called concurrently.
+     */
+    template<class Container, class BinaryPredicate>
+    auto sort(task_system& tasks, Container& container, BinaryPredicate binary_predicate) -> void {
+        static_assert(is_iterable<Container>, "Must be iterable [have begin() and end() functions.]");
+        using value_t = typename Container::value_type;
+        const auto first = std::begin(container);
+        const auto size  = static_cast<std::size_t>(calgo::distance(container));
+        const auto parts = parallel_detail::part_count(tasks, size);
+        if (parts < 2) {
+            std::sort(first, std::end(container), binary_predicate);
+            return;
+        }
+
+        const auto run = [&](auto base, unsigned part) { return parallel_detail::part_begin(base, size, parts, part); };
+        tasks.fork_join(parts, [&](unsigned part) {
+            std::sort(run(first, part), run(first, part + 1), binary_predicate);
+        });
+
+        // Ping-pong between the container and a buffer, runs double in width each round.
+        std::vector<value_t> buffer(std::make_move_iterator(first), std::make_move_iterator(std::end(container)));
+        bool in_buffer = true;
+        for (unsigned width = 1; width < parts; width *= 2, in_buffer = not in_buffer) {
+            const unsigned pairs  = (parts + 2 * width - 1) / (2 * width);
+            const unsigned pieces = std::max(1u, parts / pairs);
+            const auto merge_round = [&](auto from, auto to) {
+                for (unsigned pair = 0; pair != pairs; ++pair) {
+                    const auto lo  = 2 * pair * width;
+                    const auto mid = std::min(lo + width, parts);
+                    const auto hi  = std::min(lo + 2 * width, parts);
+                    parallel_detail::merge(tasks, pieces, run(from, lo), run(from, mid), run(from, mid), run(from, hi),
+                                           run(to, lo), binary_predicate);
+                }
+            };
+            if (in_buffer) {
+                merge_round(std::begin(buffer), first);
+            } else {
+                merge_round(first, std::begin(buffer));
+            }
+        }
+
+        if (in_buffer) {
+            std::move(std::begin(buffer), std::end(buffer), first);
+        }
+    }
+
+    template<class Container>
+    auto sort(task_system& tasks, Container& container) -> void {
+        calgo::sort(tasks, container, std::less<>{});
+    }
+
+    /**
+     * @brief Transforms each part of @p container into the matching part of @p out in parallel.
+     *
+     * @tparam Out random access iterator.
+     * @return @p out advanced past the last transformed element.
+     */
+    template<class Container, class Out, class TransformFunc>
+    auto transform(task_system& tasks, Container const& container, Out out, TransformFunc transform) noexcept -> Out {
+        static_assert(is_iterable<Container>, "Must be iterable [have begin() and end() functions.]");
+        static_assert(std::random_access_iterator<Out>, "The output must be a random access iterator to be written in parallel.");
+        const auto first = std::begin(container);
+        const auto size  = static_cast<std::size_t>(calgo::distance(container));
+        const auto parts = parallel_detail::part_count(tasks, size);
+        tasks.fork_join(parts, [&](unsigned part) {
+            const auto from = parallel_detail::part_begin(first, size, parts, part);
+            std::transform(from, parallel_detail::part_begin(first, size, parts, part + 1),
+                           std::next(out, std::distance(first, from)), transform);
+        });
+        return std::next(out, static_cast<std::ptrdiff_t>(size));
+    }
+
+    /**
+     * @brief Stable parallel erase_if: each part removes its elements in place,
+     * then the kept prefixes are moved down next to each other in order.
+     */
+    template<class Container, class Predicate>
+    auto erase_if(task_system& tasks, Container& container, Predicate predicate) noexcept -> void {
+        static_assert(is_container<Container>, "Must be an STL like Container. ");
+        using iterator_t = typename Container::iterator;
+        const auto first = std::begin(container);
+        const auto size  = static_cast<std::size_t>(calgo::distance(container));
+        const auto parts = parallel_detail::part_count(tasks, size);
+
+        std::vector<iterator_t> kept(parts);
+        tasks.fork_join(parts, [&](unsigned part) {
+            kept[part] = std::remove_if(parallel_detail::part_begin(first, size, parts, part),
+                                        parallel_detail::part_begin(first, size, parts, part + 1), predicate);
+        });
+
+        auto out = kept[0];
+        for (unsigned part = 1; part < parts; ++part) {
+            out = std::move(parallel_detail::part_begin(first, size, parts, part), kept[part], out);
+        }
+        erase_to_end(container, out);
+    }
+
+    /**
+     * @brief First element of @p container passing @p predicate , searched in parallel.
+     * Parts after a match stop early, the parts before it still finish.
+     */
+    template<class Container, class Predicate>
+    auto find_if(task_system& tasks, Container const& container, Predicate predicate) noexcept -> typename Container::const_iterator {
+        static_assert(is_container<Container>, "Must be an STL like Container. ");
+        constexpr std::size_t block = 1024;
+        const auto first = std::begin(container);
+        const auto size  = static_cast<std::size_t>(calgo::distance(container));
+        const auto parts = parallel_detail::part_count(tasks, size);
+
+        std::atomic<std::size_t> found{ size };
+        tasks.fork_join(parts, [&](unsigned part) {
+            const auto from = size * part / parts;
+            const auto to   = size * (part + 1) / parts;
+            for (auto i = from; i < to and found.load(std::memory_order_relaxed) > i; i += block) {
+                const auto block_first = std::next(first, static_cast<std::ptrdiff_t>(i));
+                const auto block_last  = std::next(first, static_cast<std::ptrdiff_t>(std::min(i + block, to)));
+                const auto match = std::find_if(block_first, block_last, predicate);
+                if (match != block_last) {
+                    auto index = static_cast<std::size_t>(std::distance(first, match));
+                    auto seen  = found.load(std::memory_order_relaxed);
+                    while (index < seen and not found.compare_exchange_weak(seen, index, std::memory_order_relaxed)) { }
+                    return;
+                }
+            }
+        });
+        return std::next(first, static_cast<std::ptrdiff_t>(found.load()));
+    }
+
+    /**
+     * @brief Parallel unique_transform(container, out, transform): every part counts the
+     * elements that differ from their predecessor, then writes their transforms at its offset.
+     *
+     * @tparam Out random access iterator.
+     * @return @p out advanced past the last written element.
+     */
+    template<class Container, class Out, class Transform>
+    auto unique_transform(task_system& tasks, Container const& container, Out out, Transform transform) noexcept -> Out {
+        static_assert(is_iterable<Container>, "Must be iterable [have begin() and end() functions.]");
+        static_assert(std::random_access_iterator<Out>, "The output must be a random access iterator to be written in parallel.");
+        const auto first = std::begin(container);
+        const auto size  = static_cast<std::size_t>(calgo::distance(container));
+        const auto parts = parallel_detail::part_count(tasks, size);
+        const auto equal = std::equal_to<typename Container::value_type>{};
+        const auto starts_run = [&](auto i) { return i == first or not equal(*std::prev(i), *i); };
+
+        std::vector<std::ptrdiff_t> offsets(parts + 1, 0);
+        tasks.fork_join(parts, [&](unsigned part) {
+            const auto last = parallel_detail::part_begin(first, size, parts, part + 1);
+            for (auto i = parallel_detail::part_begin(first, size, parts, part); i != last; ++i) {
+                offsets[part + 1] += starts_run(i);
+            }
+        });
+        std::partial_sum(std::begin(offsets), std::end(offsets), std::begin(offsets));
+
+        tasks.fork_join(parts, [&](unsigned part) {
+            auto to = std::next(out, offsets[part]);
+            const auto last = parallel_detail::part_begin(first, size, parts, part + 1);
+            for (auto i = parallel_detail::part_begin(first, size, parts, part); i != last; ++i) {
+                if (starts_run(i)) {
+                    *to++ = transform(*i);
+                }
+            }
+        });
+        return std::next(out, offsets[parts]);
+    }
+
+    /**
+     * @brief Parallel equal(container, container2, binary_predicate), parts stop at the first mismatch found.
+     */
+    template<class Container, class Container2, class BinaryPredicate>
+    auto equal(task_system& tasks, Container const& container, Container2 const& container2, BinaryPredicate binary_predicate) noexcept -> bool {
+        static_assert(is_iterable<Container>,  "Must be iterable [have begin() and end() functions.]");
+        static_assert(is_iterable<Container2>, "Must be iterable [have begin() and end() functions.]");
+        constexpr std::size_t block = 1024;
+        const auto size = static_cast<std::size_t>(calgo::distance(container));
+        if (size != static_cast<std::size_t>(calgo::distance(container2))) {
+            return false;
+        }
+
+        const auto parts = parallel_detail::part_count(tasks, size);
+        std::atomic<bool> mismatch{ false };
+        tasks.fork_join(parts, [&](unsigned part) {
+            const auto to = size * (part + 1) / parts;
+            for (auto i = size * part / parts; i < to and not mismatch.load(std::memory_order_relaxed); i += block) {
+                const auto n  = static_cast<std::ptrdiff_t>(std::min(i + block, to) - i);
+                const auto a  = std::next(std::begin(container),  static_cast<std::ptrdiff_t>(i));
+                const auto b  = std::next(std::begin(container2), static_cast<std::ptrdiff_t>(i));
+                if (not std::equal(a, std::next(a, n), b, binary_predicate)) {
+                    mismatch.store(true, std::memory_order_relaxed);
+                }
+            }
+        });
+        return not mismatch.load();
+    }
+
+    template<class Container, class Container2>
+    auto equal(task_system& tasks, Container const& container, Container2 const& container2) noexcept -> bool {
+        return calgo::equal(tasks, container, container2, std::equal_to<>{});
+    }
+
+    namespace parallel_detail {
+
+        // Tile size for splitting [first, last) across @p parts : the L1 sized tile of
+        // triangle_product_tiled, shrunk until there are a few bands per part.
+        template<class Iterator>
+        auto triangle_tile(Iterator first, Iterator last, unsigned parts) noexcept -> std::ptrdiff_t {
+            const auto size = std::distance(first, last);
+            return std::clamp<std::ptrdiff_t>(size / (8 * static_cast<std::ptrdiff_t>(parts)) + 1, 16,
+                                              triangle_detail::tile_size<std::iter_value_t<Iterator>>);
+        }
+
+        template<class Iterator>
+        auto triangle_bands(Iterator first, Iterator last, std::ptrdiff_t tile) noexcept -> std::ptrdiff_t {
+            return (triangle_detail::tile_count(first, last, tile) + 1) / 2;
+        }
+
+        // Band @p band of the tiled upper triangle pairs its row of tiles with the mirrored one from
+        // the bottom, row r holds tiles - r tiles so every band holds tiles + 1 of them but the middle one.
+        template<class Iterator, class BinaryOperation>
+        void triangle_band(Iterator first, Iterator last, std::ptrdiff_t tile, std::ptrdiff_t band, BinaryOperation& op) {
+            const auto mirror = triangle_detail::tile_count(first, last, tile) - 1 - band;
+            triangle_detail::row(first, last, tile, band, op);
+            if (mirror != band) {
+                triangle_detail::row(first, last, tile, mirror, op);
+            }
+        }
+
+        // Calls worker(part, visit) on @p parts workers, where visit(op) calls op on the pairs of
+        // every band the worker pulls off a shared counter until none are left.
+        template<class Iterator, class Worker>
+        void triangle_product(task_system& tasks, Iterator first, Iterator last, unsigned parts, Worker worker) noexcept {
+            const auto tile  = triangle_tile(first, last, parts);
+            const auto bands = triangle_bands(first, last, tile);
+            std::atomic<std::ptrdiff_t> next{ 0 };
+            tasks.fork_join(parts, [&](unsigned part) {
+                worker(part, [&](auto&& op) {
+                    for (auto band = next.fetch_add(1, std::memory_order_relaxed); band < bands;
+                         band = next.fetch_add(1, std::memory_order_relaxed)) {
+                        triangle_band(first, last, tile, band, op);
+                    }
+                });
+            });
+        }
+
+        template<class Container>
+        auto triangle_part_count(task_system const& tasks, Container const& container) noexcept -> unsigned {
+            const auto size = static_cast<std::size_t>(calgo::distance(container));
+            return part_count(tasks, size * (size - (size != 0)) / 2);
+        }
+    }
+
+    /**
+     * @brief Parallel triangle_product_tiled(container, op): the triangle is cut in bands
+     * of equal work that the workers take in turn.
+     *
+     * @param op called concurrently on different pairs, in no particular order.
+     */
+    template<class Container, class BinaryOperation>
+    auto triangle_product(task_system& tasks, Container const& container, BinaryOperation op) noexcept -> void {
+        static_assert(is_iterable<Container>, "Must be iterable [have begin() and end() functions.]");
+        const auto parts = parallel_detail::triangle_part_count(tasks, container);
+        parallel_detail::triangle_product(tasks, std::begin(container), std::end(container), parts,
+                                          [&](unsigned, auto const& visit) { visit(op); });
+    }
+
+    /**
+     * @brief Parallel triangle_product that gathers into one @p Local per worker instead of
+     * sharing state between them: op(local, a, b) only ever sees the calling worker's local.
+     *
+     * @param init initial value of every worker's local.
+     * @return the locals, one per worker, for the caller to combine.
+     */
+    template<class Container, class Local, class LocalOperation>
+    auto triangle_product(task_system& tasks, Container const& container, Local const& init, LocalOperation op) -> std::vector<Local> {
+        static_assert(is_iterable<Container>, "Must be iterable [have begin() and end() functions.]");
+        const auto parts = parallel_detail::triangle_part_count(tasks, container);
+        std::vector<Local> locals(parts, init);
+        parallel_detail::triangle_product(tasks, std::begin(container), std::end(container), parts,
+                                          [&](unsigned part, auto const& visit) {
+            // Accumulated on the worker's own stack, written back once.
+            Local local = init;
+            visit([&](auto const& a, auto const& b) { op(local, a, b); });
+            locals[part] = std::move(local);
+        });
+        return locals;
+    }
+
+    // Standard execution policies.
+
+    template<execution_policy Policy, class Container>
+    auto sort(Policy&& policy, Container& container) noexcept -> void {
+        static_assert(is_iterable<Container>, "Must be iterable [have begin() and end() functions.]");
+        std::sort(std::forward<Policy>(policy), std::begin(container), std::end(container));
+    }
+
+    template<execution_policy Policy, class Container, class BinaryPredicate>
+    auto sort(Policy&& policy, Container& container, BinaryPredicate binary_predicate) noexcept -> void {
+        static_assert(is_iterable<Container>, "Must be iterable [have begin() and end() functions.]");
+        std::sort(std::forward<Policy>(policy), std::begin(container), std::end(container), binary_predicate);
+    }
+
+    template<execution_policy Policy, class Container, class Out, class TransformFunc>
+    auto transform(Policy&& policy, Container const& container, Out out, TransformFunc transform) noexcept -> Out {
+        static_assert(is_iterable<Container>, "Must be iterable [have begin() and end() functions.]");
+        return std::transform(std::forward<Policy>(policy), std::begin(container), std::end(container), out, transform);
+    }
+
+    /**
+     * @brief erase_if with the standard parallel std::remove_if, which is stable.
+     */
+    template<execution_policy Policy, class Container, class Predicate>
+    auto erase_if(Policy&& policy, Container& container, Predicate predicate) noexcept -> void {
+        static_assert(is_container<Container>, "Must be an STL like Container. ");
+        erase_to_end(container, std::remove_if(std::forward<Policy>(policy), std::begin(container), std::end(container), predicate));
+    }
+
+    template<execution_policy Policy, class Container, class Predicate>
+    auto find_if(Policy&& policy, Container const& container, Predicate predicate) noexcept -> typename Container::const_iterator {
+        static_assert(is_container<Container>, "Must be an STL like Container. ");
+        return std::find_if(std::forward<Policy>(policy), std::begin(container), std::end(container), predicate);
+    }
+
+    /**
+     * @brief unique_transform through std::unique on a copy then std::transform, both under @p policy .
+     */
+    template<execution_policy Policy, class Container, class Out, class Transform>
+    auto unique_transform(Policy&& policy, Container const& container, Out out, Transform transform) noexcept -> Out {
+        static_assert(is_iterable<Container>, "Must be iterable [have begin() and end() functions.]");
+        std::vector<typename Container::value_type> unique(std::begin(container), std::end(container));
+        const auto last = std::unique(policy, std::begin(unique), std::end(unique));
+        return std::transform(std::forward<Policy>(policy), std::begin(unique), last, out, transform);
+    }
+
+    /**
+     * @brief triangle_product_tiled(container, op) with the bands of the triangle run under @p policy .
+     */
+    template<execution_policy Policy, class Container, class BinaryOperation>
+    auto triangle_product(Policy&& policy, Container const& container, BinaryOperation op) noexcept -> void {
+        static_assert(is_iterable<Container>, "Must be iterable [have begin() and end() functions.]");
+        const auto first = std::begin(container);
+        const auto last  = std::end(container);
+        const auto tile  = parallel_detail::triangle_tile(first, last, std::max(1u, std::thread::hardware_concurrency()));
+        std::vector<std::ptrdiff_t> bands(static_cast<std::size_t>(parallel_detail::triangle_bands(first, last, tile)));
+        std::iota(std::begin(bands), std::end(bands), std::ptrdiff_t{ 0 });
+        std::for_each(std::forward<Policy>(policy), std::begin(bands), std::end(bands), [&](std::ptrdiff_t band) {
+            parallel_detail::triangle_band(first, last, tile, band, op);
+        });
+    }
+
+    template<execution_policy Policy, class Container, class Container2>
+    auto equal(Policy&& policy, Container const& container, Container2 const& container2) noexcept -> bool {
+        static_assert(is_iterable<Container>,  "Must be iterable [have begin() and end() functions.]");
+        static_assert(is_iterable<Container2>, "Must be iterable [have begin() and end() functions.]");
+        return std::equal(std::forward<Policy>(policy), std::begin(container), std::end(container),
+                          std::begin(container2), std::end(container2));
+    }
+
+    template<execution_policy Policy, class Container, class Container2, class BinaryPredicate>
+    auto equal(Policy&& policy, Container const& container, Container2 const& container2, BinaryPredicate binary_predicate) noexcept -> bool {
+        static_assert(is_iterable<Container>,  "Must be iterable [have begin() and end() functions.]");
+        static_assert(is_iterable<Container2>, "Must be iterable [have begin() and end() functions.]");
+        return std::equal(std::forward<Policy>(policy), std::begin(container), std::end(container),
+                          std::begin(container2), std::end(container2), binary_predicate);
+    }
+}
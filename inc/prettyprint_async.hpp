@@ -0,0 +1,350 @@
+
+#ifndef H_PRETTY_PRINT_ASYNC
+#define H_PRETTY_PRINT_ASYNC
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <iterator>
+#include <memory>
+#include <new>
+#include <string_view>
+#include <thread>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+#include "prettyprint_buffer.hpp"
+#include "task_queue.hpp"
+
+// Asynchronous log sink for pretty_print.
+//
+// Formatting a large container takes milliseconds on the thread logging it. async_log_sink
+// only copies what it needs into a lock-free ring, formatting and writing happen on a
+// task_system worker. Containers of numbers, or of pairs and tuples of numbers, are copied as
+// raw elements, at most print_options::max_elements of them, and formatted by the worker.
+// Anything else is formatted by the logging thread within the print options, and its text copied.
+// A full ring drops the record rather than block the logging thread.
+
+namespace pretty_print
+{
+    namespace detail
+    {
+        // Elements copied as bytes and formatted later must not point to anything:
+        // numbers, and pairs and tuples of numbers.
+
+        template <typename T>
+        struct is_snapshot_leaf : std::bool_constant<std::is_arithmetic_v<T>> { };
+
+        template <typename T1, typename T2>
+        struct is_snapshot_leaf<std::pair<T1, T2>>
+            : std::bool_constant<is_snapshot_leaf<std::remove_const_t<T1>>::value && is_snapshot_leaf<std::remove_const_t<T2>>::value> { };
+
+        template <typename ...Args>
+        struct is_snapshot_leaf<std::tuple<Args...>>
+            : std::bool_constant<(is_snapshot_leaf<std::remove_const_t<Args>>::value && ...)> { };
+
+        inline constexpr std::size_t record_alignment = 16;
+
+        constexpr std::size_t align_record(std::size_t size) noexcept
+        {
+            return (size + record_alignment - 1) & ~(record_alignment - 1);
+        }
+
+        template <typename T>
+        using element_t = std::remove_cvref_t<decltype(*std::begin(std::declval<const T &>()))>;
+
+        template <typename T, typename = void>
+        struct is_snapshot_container : std::false_type { };
+
+        template <typename T>
+        struct is_snapshot_container<T, std::enable_if_t<is_container<T>::value && !is_string_v<T> && !is_tuple_like<T>::value>>
+            : std::bool_constant<is_snapshot_leaf<std::remove_const_t<element_t<T>>>::value &&
+                                 std::is_trivially_copy_constructible_v<element_t<T>> &&
+                                 std::is_trivially_destructible_v<element_t<T>> &&
+                                 alignof(element_t<T>) <= record_alignment> { };
+
+        // Every record starts with this header. size stays 0 until the record is published.
+
+        struct record_header
+        {
+            std::uint64_t size;
+            void (*format)(const unsigned char * payload, format_buffer & buffer);   // nullptr for padding
+        };
+
+        struct snapshot_header
+        {
+            print_options options;
+            std::uint64_t label_size;
+            std::uint64_t total;    // elements in the container
+            std::uint64_t copied;   // elements following the header
+        };
+
+        // Offset of the elements from the start of the payload.
+        constexpr std::size_t snapshot_elements(std::size_t label_size) noexcept
+        {
+            return align_record(sizeof(record_header) + sizeof(snapshot_header) + label_size) - sizeof(record_header);
+        }
+
+        template <typename T>
+        void format_snapshot(const unsigned char * payload, format_buffer & buffer)
+        {
+            using element_type = element_t<T>;
+            using values = delimiters<T, char>;
+
+            snapshot_header header;
+            std::memcpy(&header, payload, sizeof(header));
+            buffer.append({ reinterpret_cast<const char *>(payload + sizeof(header)), header.label_size });
+
+            const auto first = std::launder(reinterpret_cast<const element_type *>(payload + snapshot_elements(header.label_size)));
+            bounds limits{ header.options, buffer.size(), 1 };
+            const std::size_t copied = header.options.max_depth == 0 ? 0 : header.copied;
+
+            format_delimiter(buffer, values::values.prefix);
+            format_sequence(buffer, first, first + copied, values::values.delimiter, limits, header.total - copied);
+            format_delimiter(buffer, values::values.postfix);
+            buffer.put('\n');
+        }
+
+        inline void format_text(const unsigned char * payload, format_buffer & buffer)
+        {
+            std::uint64_t size;
+            std::memcpy(&size, payload, sizeof(size));
+            buffer.append({ reinterpret_cast<const char *>(payload + sizeof(size)), size });
+        }
+    }  // namespace detail
+
+
+    // Logs containers to a FILE from any thread, formatted on a task_system worker.
+    // Must be destroyed before the task_system, and neither flush() nor the destructor
+    // may run on a task of that same pool, they wait for its workers.
+    // Usage:
+    //     pretty_print::async_log_sink sink(tasks, stderr, 1 << 20, { .max_elements = 64 });
+    //     sink.log("associations: ", dogs.associations());
+
+    class async_log_sink
+    {
+    public:
+        // capacity is rounded up to a power of two, the largest record the ring can hold.
+        async_log_sink(task_system & tasks, std::FILE * file, std::size_t capacity = 1 << 20, print_options options = {})
+            : tasks_(tasks), file_(file), options_(options)
+        {
+            capacity_ = 4096;
+            while (capacity_ < capacity)
+                capacity_ *= 2;
+            slots_ = std::make_unique<slot[]>(capacity_ / sizeof(slot));
+            bytes_ = reinterpret_cast<unsigned char *>(slots_.get());
+        }
+
+        async_log_sink(const async_log_sink &) = delete;
+        async_log_sink & operator=(const async_log_sink &) = delete;
+
+        // Writes whatever was logged before returning.
+        ~async_log_sink() { flush(); }
+
+        // Logs label followed by value and a newline, value within the sink's print options.
+        // Returns false when the ring was full and the record dropped.
+        template <typename T>
+        bool log(std::string_view label, const T & value)
+        {
+            if constexpr (detail::is_snapshot_container<T>::value)
+                return log_snapshot(label, value);
+            else
+                return log_text(label, value);
+        }
+
+        template <typename T>
+        bool log(const T & value) { return log(std::string_view{}, value); }
+
+        // Waits until every record logged so far is written and the file flushed, and no
+        // drain() touches the sink any more.
+        void flush()
+        {
+            while (tail_.load(std::memory_order_acquire) != head_.load(std::memory_order_acquire) ||
+                   draining_.load(std::memory_order_acquire) != 0)
+                std::this_thread::yield();
+        }
+
+        // Records dropped because the ring was full.
+        std::size_t dropped() const noexcept { return dropped_.load(std::memory_order_relaxed); }
+
+    private:
+        struct alignas(detail::record_alignment) slot
+        {
+            unsigned char bytes[detail::record_alignment];
+        };
+
+        // Worker output is written once this much is pending.
+        static constexpr std::size_t flush_bytes = 1 << 16;
+
+        template <typename T>
+        bool log_snapshot(std::string_view label, const T & container)
+        {
+            using element_type = detail::element_t<T>;
+
+            auto it = std::begin(container);
+            const auto the_end = std::end(container);
+            std::size_t total;
+            if constexpr (requires { std::size(container); })
+                total = static_cast<std::size_t>(std::size(container));
+            else
+                total = static_cast<std::size_t>(std::distance(it, the_end));
+            const auto copied = options_.max_depth == 0 ? 0 : std::min(total, options_.max_elements);
+
+            const auto elements = sizeof(detail::record_header) + detail::snapshot_elements(label.size());
+            const auto size = detail::align_record(elements + copied * sizeof(element_type));
+            unsigned char * const record = reserve(size);
+            if (record == nullptr)
+                return false;
+
+            const detail::snapshot_header header{ options_, label.size(), total, copied };
+            unsigned char * const payload = record + sizeof(detail::record_header);
+            std::memcpy(payload, &header, sizeof(header));
+            // An empty label or container may have no storage to copy nothing from.
+            if (!label.empty())
+                std::memcpy(payload + sizeof(header), label.data(), label.size());
+
+            if constexpr (std::contiguous_iterator<decltype(it)>)
+            {
+                if (copied != 0)
+                    std::memcpy(record + elements, std::to_address(it), copied * sizeof(element_type));
+            }
+            else
+            {
+                auto * out = reinterpret_cast<std::remove_const_t<element_type> *>(record + elements);
+                for (std::size_t n = 0; n != copied; ++n, ++it)
+                    ::new (static_cast<void *>(out + n)) element_type(*it);
+            }
+
+            publish(record, size, &detail::format_snapshot<T>);
+            return true;
+        }
+
+        template <typename T>
+        bool log_text(std::string_view label, const T & value)
+        {
+            auto & buffer = detail::thread_buffer();
+            const auto mark = buffer.size();
+            buffer.append(label);
+            format_into(buffer, value, options_);
+            buffer.put('\n');
+
+            const std::uint64_t text = buffer.size() - mark;
+            const auto size = detail::align_record(sizeof(detail::record_header) + sizeof(text) + text);
+            unsigned char * const record = reserve(size);
+            if (record != nullptr)
+            {
+                unsigned char * const payload = record + sizeof(detail::record_header);
+                std::memcpy(payload, &text, sizeof(text));
+                std::memcpy(payload + sizeof(text), buffer.data() + mark, text);
+                publish(record, size, &detail::format_text);
+            }
+            buffer.truncate(mark);
+            return record != nullptr;
+        }
+
+        std::uint64_t & record_size(unsigned char * record) noexcept
+        {
+            return reinterpret_cast<detail::record_header *>(record)->size;
+        }
+
+        // Claims size contiguous bytes, with a padding record first when they would wrap around.
+        // nullptr when the ring is full.
+        unsigned char * reserve(std::size_t size)
+        {
+            const auto mask = capacity_ - 1;
+            auto head = head_.load(std::memory_order_relaxed);
+            std::size_t skip;
+            do
+            {
+                skip = capacity_ - (head & mask) < size ? capacity_ - (head & mask) : 0;
+                if (head + skip + size - tail_.load(std::memory_order_acquire) > capacity_)
+                {
+                    dropped_.fetch_add(1, std::memory_order_relaxed);
+                    return nullptr;
+                }
+            } while (!head_.compare_exchange_weak(head, head + skip + size, std::memory_order_relaxed));
+
+            if (skip != 0)
+                publish(bytes_ + (head & mask), skip, nullptr);
+            return bytes_ + ((head + skip) & mask);
+        }
+
+        // Hands the record to the worker, scheduling one when none is draining.
+        void publish(unsigned char * record, std::size_t size, decltype(detail::record_header::format) format)
+        {
+            reinterpret_cast<detail::record_header *>(record)->format = format;
+            std::atomic_ref<std::uint64_t>(record_size(record)).store(size, std::memory_order_release);
+
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            if (format != nullptr && !scheduled_.exchange(true, std::memory_order_acq_rel))
+            {
+                // Until the task counts itself in, the record it is for keeps tail_ short of head_.
+                draining_.fetch_add(1, std::memory_order_relaxed);
+                tasks_.async([this] { drain(); });
+            }
+        }
+
+        // Formats and writes the published records, on a worker. Each record is zeroed as it is
+        // consumed, so a later record's header never sees stale bytes. Leaving draining_ is the
+        // last thing it does with the sink, flush() and the destructor wait for it.
+        void drain()
+        {
+            const auto mask = capacity_ - 1;
+            for ( ; ; )
+            {
+                auto tail = tail_.load(std::memory_order_relaxed);
+                for ( ; ; )
+                {
+                    unsigned char * const record = bytes_ + (tail & mask);
+                    const auto size = std::atomic_ref<std::uint64_t>(record_size(record)).load(std::memory_order_acquire);
+                    if (size == 0)
+                        break;
+
+                    const auto format = reinterpret_cast<detail::record_header *>(record)->format;
+                    if (format != nullptr)
+                        format(record + sizeof(detail::record_header), buffer_);
+
+                    std::memset(record, 0, size);
+                    tail += size;
+                    tail_.store(tail, std::memory_order_release);
+
+                    if (buffer_.size() >= flush_bytes)
+                        buffer_.flush(file_);
+                }
+                buffer_.flush(file_);
+                std::fflush(file_);
+
+                // A record published after the last look but before this store saw scheduled_ set
+                // and scheduled no one, look again.
+                scheduled_.store(false, std::memory_order_seq_cst);
+                std::atomic_thread_fence(std::memory_order_seq_cst);
+                unsigned char * const record = bytes_ + (tail & mask);
+                if (std::atomic_ref<std::uint64_t>(record_size(record)).load(std::memory_order_acquire) == 0 ||
+                    scheduled_.exchange(true, std::memory_order_acq_rel))
+                    break;
+            }
+            draining_.fetch_sub(1, std::memory_order_release);
+        }
+
+        task_system &            tasks_;
+        std::FILE *              file_;
+        print_options            options_;
+        std::size_t              capacity_;
+        std::unique_ptr<slot[]>  slots_;
+        unsigned char *          bytes_;
+        format_buffer            buffer_;   // the worker's
+        alignas(64) std::atomic<std::size_t> head_{ 0 };
+        alignas(64) std::atomic<std::size_t> tail_{ 0 };
+        std::atomic<bool>        scheduled_{ false };
+        std::atomic<unsigned>    draining_{ 0 };    // drain() tasks scheduled and not done with the sink
+        std::atomic<std::size_t> dropped_{ 0 };
+    };
+
+}   // namespace pretty_print
+
+
+#endif  // H_PRETTY_PRINT_ASYNC
@@ -0,0 +1,309 @@
+
+#ifndef H_PRETTY_PRINT_BINARY
+#define H_PRETTY_PRINT_BINARY
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <iterator>
+#include <memory>
+#include <optional>
+#include <string_view>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+#include "prettyprint_buffer.hpp"
+
+// Binary serialization for pretty_print.
+//
+// Walks values the way the printers do, is_container for containers and the pair and tuple
+// printers for fields, and writes them compactly instead of as text:
+//  - trivially copyable leaves, numbers and plain structs, as their raw bytes,
+//  - containers and strings as their length, a LEB128 varint, then their elements, a single
+//    memcpy when these are leaves laid out contiguously,
+//  - pairs and tuples as their fields in order.
+// The bytes hold no type information and are only meant to be read back by the same build,
+// with the same types and byte order.
+
+namespace pretty_print
+{
+    namespace detail
+    {
+        template <typename T>
+        inline constexpr bool is_binary_leaf_v = std::is_trivially_copyable_v<T> && !std::is_pointer_v<T> &&
+                                                 !std::is_member_pointer_v<T> && !is_container<T>::value && !is_string_v<T>;
+
+        template <typename T>
+        using binary_iterator_t = decltype(std::begin(std::declval<T &>()));
+
+        template <typename T>
+        using binary_element_t = std::iter_value_t<binary_iterator_t<T>>;
+
+        // Containers of leaves stored one after another, copied with a single memcpy.
+        template <typename T>
+        inline constexpr bool is_binary_block_v = std::contiguous_iterator<binary_iterator_t<const T>> &&
+                                                  is_binary_leaf_v<binary_element_t<T>>;
+
+        inline void write_length(format_buffer & buffer, std::uint64_t length)
+        {
+            char * out = buffer.prepare(10);
+            for ( ; length >= 0x80; length >>= 7)
+                *out++ = static_cast<char>((length & 0x7f) | 0x80);
+            *out++ = static_cast<char>(length);
+            buffer.commit(out);
+        }
+
+        template <typename T>
+        void write_value(format_buffer & buffer, const T & value);
+
+        template <typename T>
+        inline void write_container(format_buffer & buffer, const T & container)
+        {
+            auto it = std::begin(container);
+            const auto the_end = std::end(container);
+            const auto length = static_cast<std::size_t>(std::distance(it, the_end));
+            write_length(buffer, length);
+
+            if constexpr (is_binary_block_v<T>)
+            {
+                buffer.append({ reinterpret_cast<const char *>(std::to_address(it)), length * sizeof(binary_element_t<T>) });
+            }
+            else
+            {
+                for ( ; it != the_end; ++it)
+                {
+                    // Through the value type, for proxies like vector<bool>'s.
+                    const binary_element_t<T> & element = *it;
+                    write_value(buffer, element);
+                }
+            }
+        }
+
+        template <typename T>
+        inline void write_value(format_buffer & buffer, const T & value)
+        {
+            if constexpr (is_string_v<T>)
+            {
+                const std::string_view text(value);
+                write_length(buffer, text.size());
+                buffer.append(text);
+            }
+            else if constexpr (is_tuple_like<T>::value)
+            {
+                std::apply([&](const auto & ... fields) { (write_value(buffer, fields), ...); }, value);
+            }
+            else if constexpr (is_container<T>::value)
+            {
+                write_container(buffer, value);
+            }
+            else
+            {
+                static_assert(is_binary_leaf_v<T>, "Has no binary form [must be a container, a pair, a tuple or trivially copyable.]");
+                buffer.append({ reinterpret_cast<const char *>(std::addressof(value)), sizeof(T) });
+            }
+        }
+    }  // namespace detail
+
+
+    // Appends the binary form of value to buffer.
+    // Usage: pretty_print::serialize(buffer, dogs.associations());
+
+    template <typename T>
+    inline void serialize(format_buffer & buffer, const T & value)
+    {
+        detail::write_value(buffer, value);
+    }
+
+
+    // Reads binary forms back from a range of bytes it does not own. Every read checks
+    // the bytes left, a failed read leaves the reader where it was.
+
+    class binary_reader
+    {
+    public:
+        binary_reader(const void * data, std::size_t size) noexcept
+        : first_(static_cast<const unsigned char *>(data)), last_(first_ + size)
+        { }
+
+        explicit binary_reader(std::string_view bytes) noexcept
+        : binary_reader(bytes.data(), bytes.size())
+        { }
+
+        std::size_t remaining() const noexcept { return static_cast<std::size_t>(last_ - first_); }
+
+        bool read(void * out, std::size_t size) noexcept
+        {
+            if (size > remaining())
+                return false;
+            if (size != 0)
+                std::memcpy(out, first_, size);
+            first_ += size;
+            return true;
+        }
+
+        bool read_length(std::uint64_t & length) noexcept
+        {
+            std::uint64_t value = 0;
+            for (auto it = first_; it != last_ && it - first_ < 10; ++it)
+            {
+                value |= static_cast<std::uint64_t>(*it & 0x7f) << (7 * (it - first_));
+                if ((*it & 0x80) == 0)
+                {
+                    first_ = it + 1;
+                    length = value;
+                    return true;
+                }
+            }
+            return false;
+        }
+
+    private:
+        const unsigned char * first_;
+        const unsigned char * last_;
+    };
+
+
+    namespace detail
+    {
+        // Type an element is read into: the const keys of map elements are assigned to.
+
+        template <typename T>
+        struct readable { using type = std::remove_const_t<T>; };
+
+        template <typename T1, typename T2>
+        struct readable<std::pair<T1, T2>> { using type = std::pair<std::remove_const_t<T1>, std::remove_const_t<T2>>; };
+
+        template <typename ...Args>
+        struct readable<std::tuple<Args...>> { using type = std::tuple<std::remove_const_t<Args>...>; };
+
+        template <typename T>
+        using readable_t = typename readable<std::remove_const_t<T>>::type;
+
+        template <typename T>
+        bool read_value(binary_reader & reader, T & value);
+
+        template <typename T>
+        inline bool read_container(binary_reader & reader, T & container)
+        {
+            using element_type = binary_element_t<T>;
+
+            std::uint64_t length;
+            if (!reader.read_length(length))
+                return false;
+
+            // Every element but an empty one takes a byte at least, which bounds what a
+            // corrupt length can make us allocate.
+            if (!std::is_empty_v<element_type> && length > reader.remaining())
+                return false;
+            const auto size = static_cast<std::size_t>(length);
+
+            if constexpr (requires { container.emplace_back(); } || requires { container.emplace_hint(container.end(), std::declval<element_type>()); })
+            {
+                container.clear();
+
+                if constexpr (is_binary_block_v<T> && requires { container.resize(size); container.data(); })
+                {
+                    if (size > reader.remaining() / sizeof(element_type))
+                        return false;
+                    container.resize(size);
+                    return reader.read(container.data(), size * sizeof(element_type));
+                }
+                else
+                {
+                    if constexpr (requires { container.reserve(size); })
+                        container.reserve(size);
+
+                    for (std::size_t n = 0; n != size; ++n)
+                    {
+                        readable_t<element_type> element{};
+                        if (!read_value(reader, element))
+                            return false;
+
+                        if constexpr (requires { container.emplace_back(std::move(element)); })
+                            container.emplace_back(std::move(element));
+                        else
+                            container.emplace_hint(container.end(), std::move(element));
+                    }
+                    return true;
+                }
+            }
+            else
+            {
+                // Fixed size containers hold as many elements as were written, valarrays are resized to.
+                if constexpr (requires { container.resize(size); })
+                    container.resize(size);
+                else if (size != static_cast<std::size_t>(std::distance(std::begin(container), std::end(container))))
+                    return false;
+
+                if constexpr (is_binary_block_v<T>)
+                {
+                    return reader.read(std::to_address(std::begin(container)), size * sizeof(element_type));
+                }
+                else
+                {
+                    for (auto & element : container)
+                    {
+                        if (!read_value(reader, element))
+                            return false;
+                    }
+                    return true;
+                }
+            }
+        }
+
+        template <typename T>
+        inline bool read_value(binary_reader & reader, T & value)
+        {
+            if constexpr (is_tuple_like<T>::value)
+            {
+                return std::apply([&](auto & ... fields) { return (read_value(reader, fields) && ...); }, value);
+            }
+            else if constexpr (is_container<T>::value)
+            {
+                return read_container(reader, value);
+            }
+            else if constexpr (std::is_same_v<T, bool>)
+            {
+                unsigned char byte;
+                if (!reader.read(&byte, 1) || byte > 1)
+                    return false;
+                value = byte != 0;
+                return true;
+            }
+            else
+            {
+                static_assert(is_binary_leaf_v<T>, "Has no binary form [must be a container, a pair, a tuple or trivially copyable.]");
+                return reader.read(std::addressof(value), sizeof(T));
+            }
+        }
+    }  // namespace detail
+
+
+    // Reads the binary form of a T from reader into value. False, and value unspecified,
+    // when the bytes end early or don't hold one.
+
+    template <typename T>
+    inline bool deserialize(binary_reader & reader, T & value)
+    {
+        return detail::read_value(reader, value);
+    }
+
+    // Reads a T from bytes, which must hold exactly its binary form.
+    // Usage: auto associations = pretty_print::deserialize<association_type>(buffer.view());
+
+    template <typename T>
+    inline std::optional<T> deserialize(std::string_view bytes)
+    {
+        binary_reader reader(bytes);
+        std::optional<T> value(std::in_place);
+        if (!deserialize(reader, *value) || reader.remaining() != 0)
+            return std::nullopt;
+        return value;
+    }
+
+}   // namespace pretty_print
+
+
+#endif  // H_PRETTY_PRINT_BINARY
@@ -0,0 +1,468 @@
+
+#ifndef H_PRETTY_PRINT_BUFFER
+#define H_PRETTY_PRINT_BUFFER
+
+#include <algorithm>
+#include <charconv>
+#include <cstddef>
+#include <cstdio>
+#include <cstring>
+#include <iterator>
+#include <memory>
+#include <sstream>
+#include <string_view>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+#include "prettyprint.hpp"
+
+#if defined(__cpp_lib_format)
+#include <format>
+#endif
+
+// Buffered backend for pretty_print.
+//
+// operator<< goes through one ostream insertion per element, delimiter, prefix and postfix,
+// each paying for a sentry, the stream's locale and a virtual call. This backend formats the
+// same text into a contiguous, reusable buffer instead: numbers with std::to_chars, delimiters
+// with memcpy, and writes it out with a single fwrite. Elements that are neither numbers,
+// strings nor containers still go through their operator<<.
+
+namespace pretty_print
+{
+    // Growable char buffer the backend formats into. Keeps its capacity when cleared,
+    // so a buffer reused across dumps stops allocating once it fits the largest one.
+
+    class format_buffer
+    {
+    public:
+        using size_type = std::size_t;
+
+        format_buffer() = default;
+        explicit format_buffer(size_type capacity) { reserve(capacity); }
+
+        const char * data() const noexcept { return data_.get(); }
+        size_type size() const noexcept { return size_; }
+        size_type capacity() const noexcept { return capacity_; }
+        bool empty() const noexcept { return size_ == 0; }
+        std::string_view view() const noexcept { return { data_.get(), size_ }; }
+
+        void clear() noexcept { size_ = 0; }
+
+        // Drops everything after the first size chars.
+        void truncate(size_type size) noexcept { size_ = std::min(size, size_); }
+
+        void reserve(size_type capacity)
+        {
+            if (capacity > capacity_)
+                grow(capacity);
+        }
+
+        void put(char c)
+        {
+            if (size_ == capacity_)
+                grow(size_ + 1);
+            data_[size_++] = c;
+        }
+
+        void append(std::string_view s)
+        {
+            // A fresh buffer has no storage to copy nothing into.
+            if (s.empty())
+                return;
+            std::memcpy(prepare(s.size()), s.data(), s.size());
+            size_ += s.size();
+        }
+
+        // Room for at least n more chars past the end, kept by commit(end of what was written).
+        char * prepare(size_type n)
+        {
+            reserve(size_ + n);
+            return data_.get() + size_;
+        }
+
+        void commit(char * end) noexcept { size_ = static_cast<size_type>(end - data_.get()); }
+
+        // Writes the contents with a single fwrite and clears them. False when the write fell short.
+        bool flush(std::FILE * file) noexcept
+        {
+            const auto written = size_ == 0 ? 0 : std::fwrite(data_.get(), 1, size_, file);
+            const bool complete = written == size_;
+            size_ = 0;
+            return complete;
+        }
+
+    private:
+        void grow(size_type needed)
+        {
+            const auto capacity = std::max({ needed, 2 * capacity_, size_type{ 256 } });
+            auto data = std::make_unique_for_overwrite<char[]>(capacity);
+            if (size_ != 0)
+                std::memcpy(data.get(), data_.get(), size_);
+            data_     = std::move(data);
+            capacity_ = capacity;
+        }
+
+        std::unique_ptr<char[]> data_;
+        size_type               size_{ 0 };
+        size_type               capacity_{ 0 };
+    };
+
+
+    namespace detail
+    {
+        // Strings print as text, even though is_container holds for std::string.
+        template <typename T>
+        inline constexpr bool is_string_v = std::is_convertible_v<const T &, std::string_view>;
+
+        template <typename T>
+        inline constexpr bool is_char_v = std::is_same_v<T, char> || std::is_same_v<T, signed char> || std::is_same_v<T, unsigned char>;
+
+        // Longest to_chars output of an integer, or of a floating point value at 6 significant digits.
+        inline constexpr std::size_t max_number_chars = 48;
+
+        inline void format_delimiter(format_buffer & buffer, const char * delimiter)
+        {
+            if (delimiter != NULL)
+                buffer.append(delimiter);
+        }
+
+        // Numbers as an ostream with default flags prints them: bool as 0 or 1, chars as
+        // characters and floating point values like %g, 6 significant digits.
+
+        template <typename T>
+        inline void format_number(format_buffer & buffer, T value)
+        {
+            if constexpr (std::is_same_v<T, bool>)
+            {
+                buffer.put(value ? '1' : '0');
+            }
+            else if constexpr (is_char_v<T>)
+            {
+                buffer.put(static_cast<char>(value));
+            }
+            else
+            {
+                char * const first = buffer.prepare(max_number_chars);
+                std::to_chars_result result;
+                if constexpr (std::is_floating_point_v<T>)
+                    result = std::to_chars(first, first + max_number_chars, value, std::chars_format::general, 6);
+                else
+                    result = std::to_chars(first, first + max_number_chars, value);
+                buffer.commit(result.ptr);
+            }
+        }
+
+        // Anything else through its operator<<, into a stream reused by the thread.
+
+        template <typename T>
+        inline void format_streamed(format_buffer & buffer, const T & value)
+        {
+            thread_local std::ostringstream stream;
+            stream.str({});
+            stream.clear();
+            stream << value;
+            buffer.append(stream.view());
+        }
+    }  // namespace detail
+
+
+    // Limits on how much of a value gets printed, for logging containers of any size.
+    // Whatever is cut is replaced by "…(N more)", N counting the elements left out.
+    // Pairs and tuples always print all of their fields.
+
+    struct print_options
+    {
+        static constexpr std::size_t unlimited = static_cast<std::size_t>(-1);
+
+        std::size_t max_elements{ unlimited };  // elements printed per container
+        std::size_t max_depth{ unlimited };     // containers nested in each other, the outermost one being 1
+        std::size_t max_bytes{ unlimited };     // bytes past which no further element is started
+    };
+
+    namespace detail
+    {
+        struct unbounded
+        {
+            static constexpr bool bounded = false;
+        };
+
+        struct bounds
+        {
+            static constexpr bool bounded = true;
+
+            print_options options;
+            std::size_t   start;        // buffer size where the value starts
+            std::size_t   depth{ 0 };   // containers entered
+        };
+
+        inline void format_more(format_buffer & buffer, std::size_t more)
+        {
+            buffer.append("\xE2\x80\xA6(");
+            format_number(buffer, more);
+            buffer.append(" more)");
+        }
+
+        template <typename T>
+        struct is_tuple_like : std::false_type { };
+
+        template <typename T1, typename T2>
+        struct is_tuple_like<std::pair<T1, T2>> : std::true_type { };
+
+        template <typename ...Args>
+        struct is_tuple_like<std::tuple<Args...>> : std::true_type { };
+
+        template <typename T, typename TDelimiters, typename Limits>
+        void format_container(format_buffer & buffer, const T & container, Limits & limits);
+
+        template <typename T, typename Limits>
+        inline void format_element(format_buffer & buffer, const T & value, Limits & limits)
+        {
+            if constexpr (is_string_v<T>)
+                buffer.append(std::string_view(value));
+            else if constexpr (is_container<T>::value)
+                format_container<T, delimiters<T, char>>(buffer, value, limits);
+            else if constexpr (std::is_arithmetic_v<T>)
+                format_number(buffer, value);
+            else
+                format_streamed(buffer, value);
+        }
+
+        // The elements of [it, the_end), then the marker for more elements already left out.
+
+        template <typename Iterator, typename Limits>
+        inline void format_sequence(format_buffer & buffer, Iterator it, const Iterator the_end,
+                                    const char * delimiter, Limits & limits, std::size_t more = 0)
+        {
+            std::size_t count = 0;
+            for ( ; it != the_end; ++it, ++count)
+            {
+                if constexpr (Limits::bounded)
+                {
+                    if (count == limits.options.max_elements || buffer.size() - limits.start >= limits.options.max_bytes)
+                    {
+                        more += static_cast<std::size_t>(std::distance(it, the_end));
+                        break;
+                    }
+                }
+
+                if (count != 0)
+                    format_delimiter(buffer, delimiter);
+
+                format_element(buffer, *it, limits);
+            }
+
+            if (more != 0)
+            {
+                if (count != 0)
+                    format_delimiter(buffer, delimiter);
+                format_more(buffer, more);
+            }
+        }
+
+        template <typename T, typename Limits>
+        inline void format_tuple(format_buffer & buffer, const T & tuple, const char * delimiter, Limits & limits)
+        {
+            std::apply([&](const auto & ... elements)
+            {
+                bool first = true;
+                ((first ? void(first = false) : format_delimiter(buffer, delimiter),
+                  format_element(buffer, elements, limits)), ...);
+            }, tuple);
+        }
+
+        // Containers, pairs and tuples, with the delimiters print_container_helper uses.
+        // Pairs and tuples stay at the depth of what holds them, only containers count.
+
+        template <typename T, typename TDelimiters, typename Limits>
+        inline void format_container(format_buffer & buffer, const T & container, Limits & limits)
+        {
+            format_delimiter(buffer, TDelimiters::values.prefix);
+
+            if constexpr (is_tuple_like<T>::value)
+            {
+                format_tuple(buffer, container, TDelimiters::values.delimiter, limits);
+            }
+            else
+            {
+                if constexpr (Limits::bounded)
+                {
+                    if (limits.depth == limits.options.max_depth)
+                    {
+                        const auto size = static_cast<std::size_t>(std::distance(std::begin(container), std::end(container)));
+                        if (size != 0)
+                            format_more(buffer, size);
+                        format_delimiter(buffer, TDelimiters::values.postfix);
+                        return;
+                    }
+                    ++limits.depth;
+                }
+
+                format_sequence(buffer, std::begin(container), std::end(container), TDelimiters::values.delimiter, limits);
+
+                if constexpr (Limits::bounded)
+                    --limits.depth;
+            }
+
+            format_delimiter(buffer, TDelimiters::values.postfix);
+        }
+
+        template <typename T, typename TDelimiters, typename Limits>
+        inline void format_value(format_buffer & buffer, const T & value, Limits & limits)
+        {
+            if constexpr (is_container<T>::value && !is_string_v<T>)
+                format_container<T, TDelimiters>(buffer, value, limits);
+            else
+                format_element(buffer, value, limits);
+        }
+    }  // namespace detail
+
+
+    // Appends value to buffer as operator<< would print it, with TDelimiters for value
+    // itself and the default delimiters for the containers inside.
+
+    template <typename T, typename TDelimiters = delimiters<T, char>>
+    inline void format_into(format_buffer & buffer, const T & value)
+    {
+        detail::unbounded limits;
+        detail::format_value<T, TDelimiters>(buffer, value, limits);
+    }
+
+    // Same within the limits of options, max_bytes counting from where value starts.
+
+    template <typename T, typename TDelimiters = delimiters<T, char>>
+    inline void format_into(format_buffer & buffer, const T & value, const print_options & options)
+    {
+        detail::bounds limits{ options, buffer.size() };
+        detail::format_value<T, TDelimiters>(buffer, value, limits);
+    }
+
+    namespace detail
+    {
+        // Buffer of the thread for fprint and std::format. Users append past a mark and
+        // truncate back to it, so a nested use doesn't clobber an outer one.
+
+        inline format_buffer & thread_buffer()
+        {
+            thread_local format_buffer buffer;
+            return buffer;
+        }
+    }  // namespace detail
+
+    namespace detail
+    {
+        // Formats with format(buffer) past the end of buffer, writes that with a single fwrite
+        // and truncates it back.
+
+        template <typename Format>
+        inline bool write_formatted(std::FILE * file, format_buffer & buffer, Format format)
+        {
+            const auto mark = buffer.size();
+            format(buffer);
+            const auto size = buffer.size() - mark;
+            const bool complete = std::fwrite(buffer.data() + mark, 1, size, file) == size;
+            buffer.truncate(mark);
+            return complete;
+        }
+    }  // namespace detail
+
+    // Formats value into buffer and writes it with a single fwrite, leaving buffer as it was.
+    // Returns false when the write fell short.
+
+    template <typename T>
+    inline bool fprint(std::FILE * file, const T & value, format_buffer & buffer)
+    {
+        return detail::write_formatted(file, buffer, [&](format_buffer & b) { format_into(b, value); });
+    }
+
+    // Same, through a buffer kept by the calling thread, which holds on to the largest dump's capacity.
+    // Usage: pretty_print::fprint(stdout, dogs.associations());
+
+    template <typename T>
+    inline bool fprint(std::FILE * file, const T & value)
+    {
+        return fprint(file, value, detail::thread_buffer());
+    }
+
+    // Same within the limits of options.
+    // Usage: pretty_print::fprint(stderr, dogs.associations(), { .max_elements = 16 });
+
+    template <typename T>
+    inline bool fprint(std::FILE * file, const T & value, const print_options & options)
+    {
+        return detail::write_formatted(file, detail::thread_buffer(), [&](format_buffer & b) { format_into(b, value, options); });
+    }
+
+
+    // Wrapper printing a value within the limits of options through operator<<.
+    // Usage: std::cout << pretty_print::bounded(dogs.associations(), { .max_elements = 16 });
+
+    template <typename T>
+    struct bounded_print
+    {
+        const T &     value;
+        print_options options;
+    };
+
+    template <typename T>
+    inline bounded_print<T> bounded(const T & value, const print_options & options)
+    {
+        return { value, options };
+    }
+
+    template <typename TCharTraits, typename T>
+    inline std::basic_ostream<char, TCharTraits> & operator<<(std::basic_ostream<char, TCharTraits> & stream, const bounded_print<T> & p)
+    {
+        auto & buffer = detail::thread_buffer();
+        const auto mark = buffer.size();
+        format_into(buffer, p.value, p.options);
+        stream.write(buffer.data() + mark, static_cast<std::streamsize>(buffer.size() - mark));
+        buffer.truncate(mark);
+        return stream;
+    }
+
+
+#if defined(__cpp_lib_format)
+
+    // Wrapper giving std::format the pretty_print text of a value, where the standard
+    // library would otherwise pick its own range or tuple formatting.
+    // Usage: std::format("{}", pretty_print::formatted(m));
+
+    template <typename T>
+    struct formatted
+    {
+        const T & value;
+    };
+
+    template <typename T>
+    formatted(const T &) -> formatted<T>;
+
+#endif
+
+}   // namespace pretty_print
+
+
+#if defined(__cpp_lib_format)
+
+template <typename T>
+struct std::formatter<pretty_print::formatted<T>, char>
+{
+    constexpr auto parse(std::format_parse_context & ctx) { return ctx.begin(); }
+
+    template <typename FormatContext>
+    auto format(const pretty_print::formatted<T> & f, FormatContext & ctx) const
+    {
+        auto & buffer = pretty_print::detail::thread_buffer();
+        const auto mark = buffer.size();
+        pretty_print::format_into(buffer, f.value);
+        auto out = std::copy(buffer.data() + mark, buffer.data() + buffer.size(), ctx.out());
+        buffer.truncate(mark);
+        return out;
+    }
+};
+
+#endif
+
+
+#endif  // H_PRETTY_PRINT_BUFFER
@@ -0,0 +1,262 @@
+
+#ifndef H_PRETTY_PRINT_JSON
+#define H_PRETTY_PRINT_JSON
+
+#include <charconv>
+#include <cmath>
+#include <cstddef>
+#include <cstdio>
+#include <iterator>
+#include <optional>
+#include <string_view>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+#include "prettyprint_buffer.hpp"
+#include "simd_kernels.hpp"
+
+// JSON output for pretty_print.
+//
+// Containers become arrays, maps with unique string keys objects, pairs and tuples arrays of their
+// fields. The brackets and commas come from json_delimiters, picked per type the way
+// delimiters are, so a container printed with custom delimiters can get its JSON form the same way.
+// Strings are scanned for the characters to escape a SIMD block at a time, floating point values
+// written with the shortest to_chars form that reads back the same, and fprint_json streams
+// to the file as the buffer fills rather than holding the whole document.
+
+namespace pretty_print
+{
+    namespace detail
+    {
+        template <typename T, typename = void>
+        struct is_json_object : std::false_type { };
+
+        // Only maps with unique keys, those whose insert reports whether it inserted: the
+        // repeated keys of a multimap would make an object most readers keep one value of.
+        template <typename T>
+        struct is_json_object<T, std::void_t<typename T::key_type, typename T::mapped_type>>
+            : std::bool_constant<is_string_v<typename T::key_type> &&
+                                 std::is_same_v<decltype(std::declval<T &>().insert(std::declval<const typename T::value_type &>())),
+                                                std::pair<typename T::iterator, bool>>> { };
+
+        template <typename T>
+        struct is_optional : std::false_type { };
+
+        template <typename T>
+        struct is_optional<std::optional<T>> : std::true_type { };
+    }  // namespace detail
+
+
+    // Delimiters of the JSON form: arrays by default, objects for maps with unique string keys,
+    // whose keys the writer follows with a colon. Multimaps are arrays of [key, value].
+
+    template <typename T, typename Enable = void>
+    struct json_delimiters { static const delimiters_values<char> values; };
+
+    template <typename T, typename Enable>
+    const delimiters_values<char> json_delimiters<T, Enable>::values = { "[", ",", "]" };
+
+    template <typename T>
+    struct json_delimiters<T, std::enable_if_t<detail::is_json_object<T>::value>> { static const delimiters_values<char> values; };
+
+    template <typename T>
+    const delimiters_values<char> json_delimiters<T, std::enable_if_t<detail::is_json_object<T>::value>>::values = { "{", ",", "}" };
+
+
+    namespace detail
+    {
+        // Output is written to file in chunks of this size when streaming.
+        inline constexpr std::size_t json_flush_bytes = 1 << 16;
+
+        // Where the JSON goes: past mark in buffer, and on to file, when there is one, as it fills.
+
+        struct json_output
+        {
+            format_buffer & buffer;
+            std::FILE *     file{ nullptr };
+            std::size_t     mark{ 0 };
+            bool            complete{ true };
+
+            void flush()
+            {
+                const auto size = buffer.size() - mark;
+                complete = std::fwrite(buffer.data() + mark, 1, size, file) == size && complete;
+                buffer.truncate(mark);
+            }
+
+            void element_written()
+            {
+                if (file != nullptr && buffer.size() - mark >= json_flush_bytes)
+                    flush();
+            }
+        };
+
+        inline void write_json_string(format_buffer & buffer, std::string_view text)
+        {
+            static constexpr char hex[] = "0123456789abcdef";
+
+            buffer.put('"');
+            const char * first = text.data();
+            const char * const last = first + text.size();
+            for ( ; ; )
+            {
+                const char * const special = calgo::simd::find_json_escape(first, last);
+                buffer.append({ first, static_cast<std::size_t>(special - first) });
+                if (special == last)
+                    break;
+
+                const auto c = static_cast<unsigned char>(*special);
+                switch (c)
+                {
+                    case '"':  buffer.append("\\\""); break;
+                    case '\\': buffer.append("\\\\"); break;
+                    case '\b': buffer.append("\\b");  break;
+                    case '\f': buffer.append("\\f");  break;
+                    case '\n': buffer.append("\\n");  break;
+                    case '\r': buffer.append("\\r");  break;
+                    case '\t': buffer.append("\\t");  break;
+                    default:
+                        buffer.append("\\u00");
+                        buffer.put(hex[c >> 4]);
+                        buffer.put(hex[c & 0xf]);
+                }
+                first = special + 1;
+            }
+            buffer.put('"');
+        }
+
+        template <typename T>
+        inline void write_json_number(format_buffer & buffer, T value)
+        {
+            if constexpr (std::is_floating_point_v<T>)
+            {
+                // JSON has no infinities nor NaN.
+                if (!std::isfinite(value))
+                {
+                    buffer.append("null");
+                    return;
+                }
+            }
+            char * const first = buffer.prepare(max_number_chars);
+            buffer.commit(std::to_chars(first, first + max_number_chars, value).ptr);
+        }
+
+        template <typename T>
+        void write_json(json_output & out, const T & value);
+
+        template <typename T>
+        inline void write_json_container(json_output & out, const T & container)
+        {
+            using values = json_delimiters<T>;
+
+            out.buffer.append(values::values.prefix);
+            bool first = true;
+            for (const auto & element : container)
+            {
+                if (!first)
+                    out.buffer.append(values::values.delimiter);
+                first = false;
+
+                if constexpr (is_json_object<T>::value)
+                {
+                    write_json_string(out.buffer, std::string_view(element.first));
+                    out.buffer.put(':');
+                    write_json(out, element.second);
+                }
+                else
+                {
+                    write_json(out, element);
+                }
+                out.element_written();
+            }
+            out.buffer.append(values::values.postfix);
+        }
+
+        template <typename T>
+        inline void write_json(json_output & out, const T & value)
+        {
+            if constexpr (is_optional<T>::value)
+            {
+                if (value)
+                    write_json(out, *value);
+                else
+                    out.buffer.append("null");
+            }
+            else if constexpr (std::is_null_pointer_v<T>)
+            {
+                out.buffer.append("null");
+            }
+            else if constexpr (std::is_same_v<T, bool>)
+            {
+                out.buffer.append(value ? "true" : "false");
+            }
+            else if constexpr (is_char_v<T>)
+            {
+                const char c = static_cast<char>(value);
+                write_json_string(out.buffer, { &c, 1 });
+            }
+            else if constexpr (std::is_arithmetic_v<T>)
+            {
+                write_json_number(out.buffer, value);
+            }
+            else if constexpr (is_string_v<T>)
+            {
+                write_json_string(out.buffer, std::string_view(value));
+            }
+            else if constexpr (is_tuple_like<T>::value)
+            {
+                using values = json_delimiters<T>;
+
+                out.buffer.append(values::values.prefix);
+                std::apply([&](const auto & ... fields)
+                {
+                    bool first = true;
+                    ((first ? void(first = false) : out.buffer.append(values::values.delimiter),
+                      write_json(out, fields)), ...);
+                }, value);
+                out.buffer.append(values::values.postfix);
+            }
+            else if constexpr (is_container<T>::value)
+            {
+                write_json_container(out, value);
+            }
+            else
+            {
+                // Anything else is the string its operator<< prints.
+                thread_local format_buffer text;
+                text.clear();
+                format_streamed(text, value);
+                write_json_string(out.buffer, text.view());
+            }
+        }
+    }  // namespace detail
+
+
+    // Appends the JSON form of value to buffer.
+
+    template <typename T>
+    inline void format_json(format_buffer & buffer, const T & value)
+    {
+        detail::json_output out{ buffer };
+        detail::write_json(out, value);
+    }
+
+    // Writes the JSON form of value to file as it is produced, 64KiB at a time, so even
+    // a large container never sits whole in memory. Returns false when a write fell short.
+    // Usage: pretty_print::fprint_json(stdout, dogs.associations());
+
+    template <typename T>
+    inline bool fprint_json(std::FILE * file, const T & value)
+    {
+        auto & buffer = detail::thread_buffer();
+        detail::json_output out{ buffer, file, buffer.size() };
+        detail::write_json(out, value);
+        out.flush();
+        return out.complete;
+    }
+
+}   // namespace pretty_print
+
+
+#endif  // H_PRETTY_PRINT_JSON
@@ -0,0 +1,428 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <functional>
+#include <iterator>
+#include <type_traits>
+#include <utility>
+#include "container_algo.hpp"
+
+// Lazy views over calgo::iterable and STL like containers.
+//
+// A pipeline of views runs as one loop when it is consumed, no stage materializes its
+// elements, and a sink writes the result straight into a container:
+//
+//     calgo::iterable(range) | calgo::views::filter(keep)
+//                            | calgo::views::transform(convert)
+//                            | calgo::views::into(flat_set);
+//
+// Views hold containers by iterators and their callables by value, so the containers
+// must outlive them and their iterators must not outlive the view. Every adaptor also
+// has a call form taking the range first: calgo::views::filter(range, keep).
+
+namespace calgo::views {
+
+    /**
+     * @brief Tag of the calgo views, what the adaptors take by value instead of by iterators.
+     */
+    struct view_base { };
+
+    namespace view_detail {
+
+        template<class T>
+        constexpr bool is_iterable_range = false;
+
+        template<class Iterator>
+        constexpr bool is_iterable_range<calgo::iterable<Iterator>> = true;
+
+        // Ranges copied into a view: calgo views and calgo::iterable, which only hold iterators.
+        template<class T>
+        constexpr bool is_view = std::is_base_of_v<view_base, std::remove_cvref_t<T>> or
+                                 is_iterable_range<std::remove_cvref_t<T>>;
+
+        template<class Range>
+        constexpr auto all(Range&& range) noexcept {
+            if constexpr (is_view<Range>) {
+                return std::remove_cvref_t<Range>(std::forward<Range>(range));
+            } else {
+                static_assert(std::is_lvalue_reference_v<Range>, "Views don't own containers, pass an lvalue.");
+                return calgo::iterable(std::begin(range), std::end(range));
+            }
+        }
+
+        template<class Range>
+        using all_t = decltype(view_detail::all(std::declval<Range>()));
+
+        template<class View>
+        using iterator_t = decltype(std::declval<View const&>().begin());
+
+        // Ranges whose size is known without walking them.
+        template<class View>
+        constexpr bool sized = requires (View const& view) { view.size(); } or
+                               std::random_access_iterator<iterator_t<View>>;
+
+        template<class View>
+        constexpr auto size(View const& view) noexcept -> std::size_t {
+            if constexpr (requires { view.size(); }) {
+                return static_cast<std::size_t>(view.size());
+            } else {
+                return static_cast<std::size_t>(std::distance(view.begin(), view.end()));
+            }
+        }
+
+        // Forward when the base iterator is and dereferencing gives a real reference, input otherwise.
+        template<class BaseIterator, class Reference>
+        using category_t = std::conditional_t<std::is_reference_v<Reference> and std::forward_iterator<BaseIterator>,
+                                              std::forward_iterator_tag, std::input_iterator_tag>;
+
+        template<class BaseIterator>
+        using concept_t = std::conditional_t<std::forward_iterator<BaseIterator>, std::forward_iterator_tag, std::input_iterator_tag>;
+
+        /**
+         * A partially applied adaptor, range | adaptor calls it with the range.
+         */
+        template<class Function>
+        struct closure {
+            Function apply;
+        };
+
+        template<class Function>
+        closure(Function) -> closure<Function>;
+
+        template<class Range, class Function>
+        constexpr decltype(auto) operator|(Range&& range, closure<Function> const& adaptor) {
+            return adaptor.apply(std::forward<Range>(range));
+        }
+    }
+
+    /**
+     * @brief The elements of the base range passing the predicate.
+     */
+    template<class Base, class Predicate>
+    class filter_view : public view_base {
+    public:
+        class iterator {
+            using base_iterator = view_detail::iterator_t<Base>;
+        public:
+            using value_type        = std::iter_value_t<base_iterator>;
+            using reference         = std::iter_reference_t<base_iterator>;
+            using difference_type   = std::ptrdiff_t;
+            using pointer           = void;
+            using iterator_category = view_detail::category_t<base_iterator, reference>;
+            using iterator_concept  = view_detail::concept_t<base_iterator>;
+
+            constexpr iterator() = default;
+            constexpr iterator(base_iterator at, base_iterator last, Predicate const* predicate)
+                : at_{ at }, last_{ last }, predicate_{ predicate } { skip(); }
+
+            constexpr auto operator*() const -> reference { return *at_; }
+            constexpr auto operator++() -> iterator& { ++at_; skip(); return *this; }
+            constexpr auto operator++(int) -> iterator { auto copy = *this; ++*this; return copy; }
+            friend constexpr bool operator==(iterator const& a, iterator const& b) { return a.at_ == b.at_; }
+
+        private:
+            constexpr void skip() {
+                while (at_ != last_ and not (*predicate_)(*at_)) {
+                    ++at_;
+                }
+            }
+
+            base_iterator    at_{};
+            base_iterator    last_{};
+            Predicate const* predicate_{ nullptr };
+        };
+
+        constexpr filter_view(Base base, Predicate predicate) : base_{ std::move(base) }, predicate_{ std::move(predicate) } { }
+
+        constexpr auto begin() const -> iterator { return { std::begin(base_), std::end(base_), &predicate_ }; }
+        constexpr auto end()   const -> iterator { return { std::end(base_),   std::end(base_), &predicate_ }; }
+
+    private:
+        Base      base_;
+        Predicate predicate_;
+    };
+
+    /**
+     * @brief The base range's elements passed through a function, called on every dereference.
+     */
+    template<class Base, class Function>
+    class transform_view : public view_base {
+    public:
+        class iterator {
+            using base_iterator = view_detail::iterator_t<Base>;
+        public:
+            using reference         = std::invoke_result_t<Function const&, std::iter_reference_t<base_iterator>>;
+            using value_type        = std::remove_cvref_t<reference>;
+            using difference_type   = std::ptrdiff_t;
+            using pointer           = void;
+            using iterator_category = view_detail::category_t<base_iterator, reference>;
+            using iterator_concept  = view_detail::concept_t<base_iterator>;
+
+            constexpr iterator() = default;
+            constexpr iterator(base_iterator at, Function const* function) : at_{ at }, function_{ function } { }
+
+            constexpr auto operator*() const -> reference { return (*function_)(*at_); }
+            constexpr auto operator++() -> iterator& { ++at_; return *this; }
+            constexpr auto operator++(int) -> iterator { auto copy = *this; ++*this; return copy; }
+            friend constexpr bool operator==(iterator const& a, iterator const& b) { return a.at_ == b.at_; }
+
+        private:
+            base_iterator   at_{};
+            Function const* function_{ nullptr };
+        };
+
+        constexpr transform_view(Base base, Function function) : base_{ std::move(base) }, function_{ std::move(function) } { }
+
+        constexpr auto begin() const -> iterator { return { std::begin(base_), &function_ }; }
+        constexpr auto end()   const -> iterator { return { std::end(base_),   &function_ }; }
+
+        constexpr auto size() const noexcept -> std::size_t requires view_detail::sized<Base> { return view_detail::size(base_); }
+
+    private:
+        Base     base_;
+        Function function_;
+    };
+
+    /**
+     * @brief The base range without the elements equal to the one before them,
+     * the lazy counterpart of calgo::erase_duplicates.
+     */
+    template<class Base, class Equal>
+    class unique_view : public view_base {
+    public:
+        class iterator {
+            using base_iterator = view_detail::iterator_t<Base>;
+        public:
+            using value_type        = std::iter_value_t<base_iterator>;
+            using reference         = std::iter_reference_t<base_iterator>;
+            using difference_type   = std::ptrdiff_t;
+            using pointer           = void;
+            using iterator_category = view_detail::category_t<base_iterator, reference>;
+            using iterator_concept  = std::forward_iterator_tag;
+
+            constexpr iterator() = default;
+            constexpr iterator(base_iterator at, base_iterator last, Equal const* equal) : at_{ at }, last_{ last }, equal_{ equal } { }
+
+            constexpr auto operator*() const -> reference { return *at_; }
+            constexpr auto operator++() -> iterator& {
+                const auto previous = at_;
+                while (++at_ != last_ and (*equal_)(*previous, *at_)) { }
+                return *this;
+            }
+            constexpr auto operator++(int) -> iterator { auto copy = *this; ++*this; return copy; }
+            friend constexpr bool operator==(iterator const& a, iterator const& b) { return a.at_ == b.at_; }
+
+        private:
+            base_iterator at_{};
+            base_iterator last_{};
+            Equal const*  equal_{ nullptr };
+        };
+
+        static_assert(std::forward_iterator<view_detail::iterator_t<Base>>, "unique looks back at the previous element, the base must be a forward range.");
+
+        constexpr unique_view(Base base, Equal equal) : base_{ std::move(base) }, equal_{ std::move(equal) } { }
+
+        constexpr auto begin() const -> iterator { return { std::begin(base_), std::end(base_), &equal_ }; }
+        constexpr auto end()   const -> iterator { return { std::end(base_),   std::end(base_), &equal_ }; }
+
+    private:
+        Base  base_;
+        Equal equal_;
+    };
+
+    /**
+     * @brief The first count elements of the base range, or all of them when it is shorter.
+     */
+    template<class Base>
+    class take_view : public view_base {
+    public:
+        class iterator {
+            using base_iterator = view_detail::iterator_t<Base>;
+        public:
+            using value_type        = std::iter_value_t<base_iterator>;
+            using reference         = std::iter_reference_t<base_iterator>;
+            using difference_type   = std::ptrdiff_t;
+            using pointer           = void;
+            using iterator_category = view_detail::category_t<base_iterator, reference>;
+            using iterator_concept  = view_detail::concept_t<base_iterator>;
+
+            constexpr iterator() = default;
+            constexpr iterator(base_iterator at, std::size_t left) : at_{ at }, left_{ left } { }
+
+            constexpr auto operator*() const -> reference { return *at_; }
+            constexpr auto operator++() -> iterator& { ++at_; --left_; return *this; }
+            constexpr auto operator++(int) -> iterator { auto copy = *this; ++*this; return copy; }
+            // The end is reached by running out of either the count or the base range.
+            friend constexpr bool operator==(iterator const& a, iterator const& b) { return a.left_ == b.left_ or a.at_ == b.at_; }
+
+        private:
+            base_iterator at_{};
+            std::size_t   left_{ 0 };
+        };
+
+        constexpr take_view(Base base, std::size_t count) : base_{ std::move(base) }, count_{ count } { }
+
+        constexpr auto begin() const -> iterator { return { std::begin(base_), count_ }; }
+        constexpr auto end()   const -> iterator { return { std::end(base_), 0 }; }
+
+        constexpr auto size() const noexcept -> std::size_t requires view_detail::sized<Base> {
+            return std::min(count_, view_detail::size(base_));
+        }
+
+    private:
+        Base        base_;
+        std::size_t count_;
+    };
+
+    /**
+     * @brief Pairs of the elements at the same position in two ranges, as long as the shorter one.
+     */
+    template<class Base1, class Base2>
+    class zip_view : public view_base {
+    public:
+        class iterator {
+            using base_iterator1 = view_detail::iterator_t<Base1>;
+            using base_iterator2 = view_detail::iterator_t<Base2>;
+        public:
+            using reference         = std::pair<std::iter_reference_t<base_iterator1>, std::iter_reference_t<base_iterator2>>;
+            using value_type        = std::pair<std::iter_value_t<base_iterator1>, std::iter_value_t<base_iterator2>>;
+            using difference_type   = std::ptrdiff_t;
+            using pointer           = void;
+            using iterator_category = std::input_iterator_tag;
+            using iterator_concept  = std::conditional_t<std::forward_iterator<base_iterator1> and std::forward_iterator<base_iterator2>,
+                                                         std::forward_iterator_tag, std::input_iterator_tag>;
+
+            constexpr iterator() = default;
+            constexpr iterator(base_iterator1 at1, base_iterator2 at2) : at1_{ at1 }, at2_{ at2 } { }
+
+            constexpr auto operator*() const -> reference { return { *at1_, *at2_ }; }
+            constexpr auto operator++() -> iterator& { ++at1_; ++at2_; return *this; }
+            constexpr auto operator++(int) -> iterator { auto copy = *this; ++*this; return copy; }
+            friend constexpr bool operator==(iterator const& a, iterator const& b) { return a.at1_ == b.at1_ or a.at2_ == b.at2_; }
+
+        private:
+            base_iterator1 at1_{};
+            base_iterator2 at2_{};
+        };
+
+        constexpr zip_view(Base1 base1, Base2 base2) : base1_{ std::move(base1) }, base2_{ std::move(base2) } { }
+
+        constexpr auto begin() const -> iterator { return { std::begin(base1_), std::begin(base2_) }; }
+        constexpr auto end()   const -> iterator { return { std::end(base1_),   std::end(base2_) }; }
+
+        constexpr auto size() const noexcept -> std::size_t requires (view_detail::sized<Base1> and view_detail::sized<Base2>) {
+            return std::min(view_detail::size(base1_), view_detail::size(base2_));
+        }
+
+    private:
+        Base1 base1_;
+        Base2 base2_;
+    };
+
+    template<class Range, class Predicate>
+    constexpr auto filter(Range&& range, Predicate predicate) {
+        return filter_view<view_detail::all_t<Range>, Predicate>{ view_detail::all(std::forward<Range>(range)), std::move(predicate) };
+    }
+
+    template<class Predicate>
+    constexpr auto filter(Predicate predicate) {
+        return view_detail::closure{ [predicate](auto&& range) { return views::filter(std::forward<decltype(range)>(range), predicate); } };
+    }
+
+    template<class Range, class Function>
+    constexpr auto transform(Range&& range, Function function) {
+        return transform_view<view_detail::all_t<Range>, Function>{ view_detail::all(std::forward<Range>(range)), std::move(function) };
+    }
+
+    template<class Function>
+    constexpr auto transform(Function function) {
+        return view_detail::closure{ [function](auto&& range) { return views::transform(std::forward<decltype(range)>(range), function); } };
+    }
+
+    template<class Range, class Equal = std::equal_to<>>
+        requires is_iterable<std::remove_cvref_t<Range>>
+    constexpr auto unique(Range&& range, Equal equal = {}) {
+        return unique_view<view_detail::all_t<Range>, Equal>{ view_detail::all(std::forward<Range>(range)), std::move(equal) };
+    }
+
+    template<class Equal = std::equal_to<>>
+        requires (not is_iterable<std::remove_cvref_t<Equal>>)
+    constexpr auto unique(Equal equal = {}) {
+        return view_detail::closure{ [equal](auto&& range) { return views::unique(std::forward<decltype(range)>(range), equal); } };
+    }
+
+    template<class Range>
+    constexpr auto take(Range&& range, std::size_t count) {
+        return take_view<view_detail::all_t<Range>>{ view_detail::all(std::forward<Range>(range)), count };
+    }
+
+    constexpr auto take(std::size_t count) {
+        return view_detail::closure{ [count](auto&& range) { return views::take(std::forward<decltype(range)>(range), count); } };
+    }
+
+    template<class Range1, class Range2>
+    constexpr auto zip(Range1&& range1, Range2&& range2) {
+        return zip_view<view_detail::all_t<Range1>, view_detail::all_t<Range2>>{
+            view_detail::all(std::forward<Range1>(range1)), view_detail::all(std::forward<Range2>(range2)) };
+    }
+
+    /**
+     * @brief range | zip(range2) pairs the elements of range with those of @p range2 .
+     */
+    template<class Range2>
+    constexpr auto zip(Range2&& range2) {
+        return view_detail::closure{ [base2 = view_detail::all(std::forward<Range2>(range2))](auto&& range) {
+            return views::zip(std::forward<decltype(range)>(range), base2);
+        } };
+    }
+
+    /**
+     * @brief Sink appending a range to @p container in one go, after making room for it when
+     * its size is known. Sorted containers such as boost's flat ones get a single range insert:
+     * the elements are appended, sorted and merged once instead of being shifted in one by one.
+     *
+     * @return @p container .
+     */
+    template<class Range, class Container>
+    auto into(Range&& range, Container& container) -> Container& {
+        static_assert(is_iterable<Container>, "Must be iterable [have begin() and end() functions.]");
+        const auto view = view_detail::all(std::forward<Range>(range));
+        if constexpr (view_detail::sized<decltype(view)> and requires { container.reserve(container.capacity()); }) {
+            // Grown geometrically, reserving the exact size on every call would reallocate on every call.
+            const auto needed = container.size() + view_detail::size(view);
+            if (needed > container.capacity()) {
+                container.reserve(std::max<std::size_t>(needed, 2 * container.capacity()));
+            }
+        }
+
+        if constexpr (requires { container.insert(view.begin(), view.end()); }) {
+            container.insert(view.begin(), view.end());
+        } else {
+            container.insert(std::end(container), view.begin(), view.end());
+        }
+        return container;
+    }
+
+    template<class Container>
+    auto into(Container& container) {
+        return view_detail::closure{ [&container](auto&& range) -> Container& {
+            return views::into(std::forward<decltype(range)>(range), container);
+        } };
+    }
+
+    /**
+     * @brief Sink building a new @p Container from a range, see into.
+     */
+    template<class Container, class Range>
+    auto to(Range&& range) -> Container {
+        Container container;
+        views::into(std::forward<Range>(range), container);
+        return container;
+    }
+
+    template<class Container>
+    auto to() {
+        return view_detail::closure{ [](auto&& range) { return views::to<Container>(std::forward<decltype(range)>(range)); } };
+    }
+}
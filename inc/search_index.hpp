@@ -0,0 +1,238 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <functional>
+#include <iterator>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#include "container_algo.hpp"
+#include "simd_kernels.hpp"
+
+// Read optimized search over a sorted container that rarely changes.
+//
+// Binary search over a sorted array touches a new cache line at nearly every level. The index
+// copies the keys into an implicit B+ tree of one cache line per node instead, five lines for a
+// million integers. The keys stay in order in its last layer, so where a search ends is the
+// position in the container. 32 and 64 bit integer keys rank a whole node with one or two SIMD compares,
+// and batched lookups walk several searches down together, prefetching their next nodes.
+// Results are positions in the indexed container, the index has to be rebuilt after it changes.
+
+namespace calgo {
+
+    namespace index_detail {
+
+        // Nodes start on a cache line.
+        template<class T>
+        struct cache_aligned_allocator {
+            using value_type = T;
+            static constexpr std::align_val_t alignment{ 64 };
+
+            cache_aligned_allocator() = default;
+            template<class U>
+            constexpr cache_aligned_allocator(cache_aligned_allocator<U> const&) noexcept {}
+
+            auto allocate(std::size_t n) -> T* {
+                return static_cast<T*>(::operator new(n * sizeof(T), alignment));
+            }
+            auto deallocate(T* p, std::size_t) noexcept -> void {
+                ::operator delete(p, alignment);
+            }
+            friend constexpr bool operator==(cache_aligned_allocator const&, cache_aligned_allocator const&) noexcept { return true; }
+        };
+
+        template<class Key, class Compare>
+        constexpr bool vectorized = simd::is_vectorizable_ordered<Key> and
+            (std::is_same_v<Compare, std::less<>> or std::is_same_v<Compare, std::less<Key>>);
+
+        template<class Container, class Projection>
+        using key_t = std::remove_cvref_t<std::invoke_result_t<Projection&, range_value_t<Container const> const&>>;
+
+        // Lookups batched per walk down the tree.
+        constexpr std::size_t batch = 16;
+    }
+
+    /**
+     * @brief Static search index over the keys of a sorted container.
+     *
+     * Built from any sorted calgo compatible container, e.g. a boost flat_set, or a flat_multimap's
+     * keys through a projection. Answers are positions in that container, container.size() when
+     * none, and stay valid until it changes: call rebuild() after inserting or erasing.
+     *
+     * @tparam Key key type, copied into the index.
+     * @tparam Compare strict weak ordering the container is sorted by.
+     */
+    template<class Key, class Compare = std::less<>>
+    class search_index {
+    public:
+        using key_type  = Key;
+        using size_type = std::size_t;
+
+        static constexpr size_type node_keys = simd::detail::btree_node_keys<Key>;
+
+        search_index() = default;
+
+        template<class Container, class Projection = std::identity>
+        explicit search_index(Container const& sorted, Projection projection = {}, Compare comp = {})
+            : comp_(comp)
+        {
+            rebuild(sorted, projection);
+        }
+
+        /**
+         * @brief Indexes @p sorted again, after it changed.
+         *
+         * complexity : O(n).
+         */
+        template<class Container, class Projection = std::identity>
+        auto rebuild(Container const& sorted, Projection projection = {}) -> void {
+            static_assert(is_iterable<Container const>, "Must be iterable [have begin() and end() functions.]");
+            size_ = static_cast<size_type>(calgo::distance(sorted));
+            tree_.clear();
+            layers_.clear();
+            if (size_ == 0) return;
+
+            // Node counts from the leaves up, each node has node_keys + 1 children.
+            std::vector<size_type> nodes{ (size_ + node_keys - 1) / node_keys };
+            while (nodes.back() > 1) {
+                nodes.push_back((nodes.back() + node_keys) / (node_keys + 1));
+            }
+            layers_.resize(nodes.size() + 1);
+            for (size_type h = 0; h != nodes.size(); ++h) {
+                layers_[h + 1] = layers_[h] + nodes[nodes.size() - 1 - h] * node_keys;
+            }
+            tree_.resize(layers_.back());
+
+            // The last layer is the keys in order, padded with the last one, which keeps every
+            // search on the real keys.
+            const auto leaves = tree_.begin() + static_cast<std::ptrdiff_t>(layers_[nodes.size() - 1]);
+            std::transform(std::begin(sorted), std::end(sorted), leaves, std::ref(projection));
+            std::fill(leaves + static_cast<std::ptrdiff_t>(size_), tree_.end(), leaves[static_cast<std::ptrdiff_t>(size_ - 1)]);
+
+            // Key i of an inner node is the smallest key under its child i + 1, the first key of
+            // that child's leftmost leaf, padding when the child doesn't exist.
+            size_type span = 1; // leaves under a node of the layer below
+            for (size_type h = nodes.size() - 1; h-- > 0; span *= node_keys + 1) {
+                const auto below = nodes[nodes.size() - 2 - h];
+                for (size_type node = 0; node != nodes[nodes.size() - 1 - h]; ++node) {
+                    for (size_type i = 0; i != node_keys; ++i) {
+                        const auto child = node * (node_keys + 1) + i + 1;
+                        tree_[layers_[h] + node * node_keys + i] = child < below ? leaves[static_cast<std::ptrdiff_t>(child * span * node_keys)]
+                                                                                 : tree_.back();
+                    }
+                }
+            }
+        }
+
+        [[nodiscard]] auto size()  const noexcept -> size_type { return size_; }
+        [[nodiscard]] auto empty() const noexcept -> bool { return size_ == 0; }
+
+        /**
+         * @brief Position of the first key not less than @p key , size() when none.
+         */
+        [[nodiscard]] auto lower_bound(Key const& key) const noexcept -> size_type {
+            return search<false>(key);
+        }
+
+        /**
+         * @brief Position of the first key greater than @p key , size() when none.
+         */
+        [[nodiscard]] auto upper_bound(Key const& key) const noexcept -> size_type {
+            return search<true>(key);
+        }
+
+        /**
+         * @brief Positions [first, second) of the keys equivalent to @p key .
+         */
+        [[nodiscard]] auto equal_range(Key const& key) const noexcept -> std::pair<size_type, size_type> {
+            const auto first = lower_bound(key);
+            if (first == size_ or comp_(key, leaf(first))) {
+                return { first, first };
+            }
+            return { first, upper_bound(key) };
+        }
+
+        [[nodiscard]] auto contains(Key const& key) const noexcept -> bool {
+            const auto first = lower_bound(key);
+            return first != size_ and not comp_(key, leaf(first));
+        }
+
+        /**
+         * @brief Calls @p operation (probe, position) with the lower_bound of every key of @p probes .
+         *
+         * Walks 16 searches down the tree together, prefetching each one's next node, so their
+         * node loads overlap instead of waiting on each other.
+         */
+        template<class Probes, class Operation>
+        auto lower_bound_each(Probes const& probes, Operation operation) const -> void {
+            static_assert(is_iterable<Probes const>, "Must be iterable [have begin() and end() functions.]");
+            Key values[index_detail::batch];
+            size_type positions[index_detail::batch];
+            auto probe = std::begin(probes);
+            const auto last = std::end(probes);
+            while (probe != last) {
+                size_type count = 0;
+                for (auto it = probe; it != last and count != index_detail::batch; ++it) {
+                    values[count++] = *it;
+                }
+                descend<false>(values, count, positions);
+                for (size_type j = 0; j != count; ++j, ++probe) {
+                    operation(*probe, positions[j]);
+                }
+            }
+        }
+
+    private:
+        [[nodiscard]] auto leaf(size_type position) const noexcept -> Key const& {
+            return tree_[layers_[layers_.size() - 2] + position];
+        }
+
+        template<bool Upper>
+        [[nodiscard]] auto search(Key const& key) const noexcept -> size_type {
+            size_type position;
+            descend<Upper>(&key, 1, &position);
+            return position;
+        }
+
+        // Positions of the searches clamped to size_, past the padding.
+        template<bool Upper>
+        auto descend(Key const* values, size_type count, size_type* positions) const noexcept -> void {
+            // An empty index has no tree to walk, every search ends at 0.
+            if (size_ == 0) {
+                std::fill_n(positions, count, size_type{ 0 });
+                return;
+            }
+            const auto height = layers_.empty() ? 0 : layers_.size() - 1;
+            if constexpr (index_detail::vectorized<Key, Compare>) {
+                simd::btree_search<Upper>(tree_.data(), layers_.data(), height, values, count, positions);
+            } else {
+                simd::detail::btree_search<node_keys>(tree_.data(), layers_.data(), height, values, count, positions, [this](Key const* node, Key const& value) {
+                    unsigned rank = 0;
+                    for (size_type i = 0; i != node_keys; ++i) {
+                        rank += Upper ? not comp_(value, node[i]) : comp_(node[i], value);
+                    }
+                    return rank;
+                });
+            }
+            for (size_type j = 0; j != count; ++j) {
+                positions[j] = std::min(positions[j], size_);
+            }
+        }
+
+        std::vector<Key, index_detail::cache_aligned_allocator<Key>> tree_;
+        std::vector<size_type>                                       layers_;
+        size_type                                                    size_{ 0 };
+        [[no_unique_address]] Compare                                comp_{};
+    };
+
+    template<class Container>
+    search_index(Container const&) -> search_index<index_detail::key_t<Container, std::identity>>;
+
+    template<class Container, class Projection>
+    search_index(Container const&, Projection) -> search_index<index_detail::key_t<Container, Projection>>;
+
+    template<class Container, class Projection, class Compare>
+    search_index(Container const&, Projection, Compare) -> search_index<index_detail::key_t<Container, Projection>, Compare>;
+}
@@ -0,0 +1,624 @@
+#pragma once
+
+#include <algorithm>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+
+#if (defined(__x86_64__) or defined(__i386__)) and defined(__GNUC__)
+#include <immintrin.h>
+#define CALGO_SIMD_X86 1
+#else
+#define CALGO_SIMD_X86 0
+#endif
+
+// Vectorized kernels behind calgo's searches over contiguous ranges.
+//
+// Every kernel is compiled for SSE2, AVX2 and AVX-512 through target attributes, the
+// widest one the CPU supports is picked at runtime, and targets other than x86
+// fall back to the scalar standard algorithms.
+
+namespace calgo::simd {
+
+    enum class isa : unsigned char { scalar, sse2, avx2, avx512 };
+
+    /**
+     * @brief Widest instruction set of this CPU the kernels have a version for, detected once.
+     */
+    inline auto detected_isa() noexcept -> isa {
+#if CALGO_SIMD_X86
+        static const isa best = [] {
+            __builtin_cpu_init();
+            if (__builtin_cpu_supports("avx512f") and __builtin_cpu_supports("avx512bw")) return isa::avx512;
+            if (__builtin_cpu_supports("avx2")) return isa::avx2;
+            if (__builtin_cpu_supports("sse2")) return isa::sse2;
+            return isa::scalar;
+        }();
+        return best;
+#else
+        return isa::scalar;
+#endif
+    }
+
+    /**
+     * @brief Types the kernels handle: integers, enums and pointers compared bit for bit,
+     * floats and doubles compared as numbers so 0.0 matches -0.0 and NaN matches nothing.
+     */
+    template<class T>
+    constexpr bool is_vectorizable =
+        ((std::is_integral_v<T> or std::is_enum_v<T> or std::is_pointer_v<T>) and
+         (sizeof(T) == 1 or sizeof(T) == 2 or sizeof(T) == 4 or sizeof(T) == 8)) or
+        std::is_same_v<T, float> or std::is_same_v<T, double>;
+
+    /**
+     * @brief Types the sorted kernels order with SIMD compares: 32 and 64 bit integers.
+     */
+    template<class T>
+    constexpr bool is_vectorizable_ordered = std::is_integral_v<T> and (sizeof(T) == 4 or sizeof(T) == 8);
+
+    namespace detail {
+
+        template<std::size_t Size>
+        using lane_t = std::conditional_t<Size == 1, std::uint8_t,
+                       std::conditional_t<Size == 2, std::uint16_t,
+                       std::conditional_t<Size == 4, std::uint32_t, std::uint64_t>>>;
+
+        template<class T>
+        auto bits(T value) noexcept -> lane_t<sizeof(T)> {
+            return std::bit_cast<lane_t<sizeof(T)>>(value);
+        }
+
+        // Copies the elements of [first, last) that don't equal value down to out.
+        template<class T>
+        auto remove_scalar(T const* first, T const* last, T* out, T value) noexcept -> T* {
+            for (; first != last; ++first) {
+                if (not (*first == value)) {
+                    *out++ = *first;
+                }
+            }
+            return out;
+        }
+
+        // First char of [first, last) a JSON string has to escape: a quote, a backslash or a control character.
+        inline auto find_json_escape_scalar(char const* first, char const* last) noexcept -> char const* {
+            return std::find_if(first, last, [](char c) {
+                return c == '"' or c == '\\' or static_cast<unsigned char>(c) < 0x20;
+            });
+        }
+
+        // Merge intersection of sorted ranges, skip(first, last, value) returns the first element
+        // of [first, last) not less than value knowing *first is less. Same output as std::set_intersection.
+        template<class T, class U, class Operation, class Skip>
+        auto intersect(T* first1, T* last1, U const* first2, U const* last2, Operation& operation, Skip skip) noexcept -> void {
+            while (first1 != last1 and first2 != last2) {
+                if (*first1 < *first2) {
+                    first1 = skip(first1, last1, *first2);
+                } else if (*first2 < *first1) {
+                    first2 = skip(first2, last2, *first1);
+                } else {
+                    operation(*first1++);
+                    ++first2;
+                }
+            }
+        }
+
+        // Keys per node of the implicit B+ trees searched by btree_search: a cache line, at least two.
+        template<class T>
+        constexpr std::size_t btree_node_keys = std::max<std::size_t>(64 / sizeof(T), 2);
+
+        // Walks count searches down an implicit B+ tree together, a layer at a time, so the node
+        // loads of the searches overlap; the next node of each is prefetched as soon as it is known.
+        // rank(node, value) counts the keys of a node that go before value.
+        template<std::size_t Keys, class T, class Rank>
+        auto btree_search(T const* tree, std::size_t const* layers, std::size_t height, T const* values,
+                          std::size_t count, std::size_t* positions, Rank rank) noexcept -> void {
+            std::size_t node[16] = {};
+            for (std::size_t h = 0; h != height; ++h) {
+                const auto layer = tree + layers[h];
+                if (h + 1 == height) {
+                    for (std::size_t j = 0; j != count; ++j) {
+                        positions[j] = node[j] * Keys + rank(layer + node[j] * Keys, values[j]);
+                    }
+                    return;
+                }
+                // Children past the end of the layer below only hold padding, searches going there
+                // are past every key and the last node answers as well.
+                const auto last = (layers[h + 2] - layers[h + 1]) / Keys - 1;
+                for (std::size_t j = 0; j != count; ++j) {
+                    node[j] = std::min(node[j] * (Keys + 1) + rank(layer + node[j] * Keys, values[j]), last);
+                    __builtin_prefetch(tree + layers[h + 1] + node[j] * Keys);
+                }
+            }
+        }
+
+#if CALGO_SIMD_X86
+
+        // Each ISA provides match (block, needle), a mask with bit (i * stride) set when lane i
+        // equals the needle, then find and remove share the same shape: scan whole blocks,
+        // finish the tail with the scalar code. remove copies [first, last) down to out <= first
+        // and stores blocks without a match as is, a block never reaches past the one just loaded.
+
+        struct sse2 {
+            using vector = __m128i;
+            static constexpr std::size_t bytes = 16;
+
+            template<class T>
+            static constexpr std::size_t stride = sizeof(T);
+
+            template<class T>
+            [[gnu::target("sse2")]] static auto broadcast(T value) noexcept -> vector {
+                if constexpr (std::is_same_v<T, float>)  return _mm_castps_si128(_mm_set1_ps(value));
+                else if constexpr (std::is_same_v<T, double>) return _mm_castpd_si128(_mm_set1_pd(value));
+                else if constexpr (sizeof(T) == 1) return _mm_set1_epi8(static_cast<char>(bits(value)));
+                else if constexpr (sizeof(T) == 2) return _mm_set1_epi16(static_cast<short>(bits(value)));
+                else if constexpr (sizeof(T) == 4) return _mm_set1_epi32(static_cast<int>(bits(value)));
+                else return _mm_set1_epi64x(static_cast<long long>(bits(value)));
+            }
+
+            template<class T>
+            [[gnu::target("sse2")]] static auto match(vector block, vector needle) noexcept -> std::uint64_t {
+                vector equal;
+                if constexpr (std::is_same_v<T, float>) {
+                    equal = _mm_castps_si128(_mm_cmpeq_ps(_mm_castsi128_ps(block), _mm_castsi128_ps(needle)));
+                } else if constexpr (std::is_same_v<T, double>) {
+                    equal = _mm_castpd_si128(_mm_cmpeq_pd(_mm_castsi128_pd(block), _mm_castsi128_pd(needle)));
+                } else if constexpr (sizeof(T) == 1) {
+                    equal = _mm_cmpeq_epi8(block, needle);
+                } else if constexpr (sizeof(T) == 2) {
+                    equal = _mm_cmpeq_epi16(block, needle);
+                } else if constexpr (sizeof(T) == 4) {
+                    equal = _mm_cmpeq_epi32(block, needle);
+                } else {
+                    // No 64 bit compare before SSE4.1: both 32 bit halves have to match.
+                    equal = _mm_cmpeq_epi32(block, needle);
+                    equal = _mm_and_si128(equal, _mm_shuffle_epi32(equal, _MM_SHUFFLE(2, 3, 0, 1)));
+                }
+                return static_cast<std::uint32_t>(_mm_movemask_epi8(equal));
+            }
+
+            template<class T>
+            [[gnu::target("sse2")]] static auto find(T const* first, T const* last, T value) noexcept -> T const* {
+                constexpr std::size_t lanes = bytes / sizeof(T);
+                const auto needle = broadcast(value);
+                for (; static_cast<std::size_t>(last - first) >= lanes; first += lanes) {
+                    const auto block = _mm_loadu_si128(reinterpret_cast<vector const*>(first));
+                    if (auto mask = match<T>(block, needle)) {
+                        return first + std::countr_zero(mask) / stride<T>;
+                    }
+                }
+                return std::find(first, last, value);
+            }
+
+            template<class T>
+            [[gnu::target("sse2")]] static auto remove(T const* first, T const* last, T* out, T value) noexcept -> T* {
+                constexpr std::size_t lanes = bytes / sizeof(T);
+                const auto needle = broadcast(value);
+                for (; static_cast<std::size_t>(last - first) >= lanes; first += lanes) {
+                    const auto block = _mm_loadu_si128(reinterpret_cast<vector const*>(first));
+                    if (match<T>(block, needle) == 0) {
+                        _mm_storeu_si128(reinterpret_cast<vector*>(out), block);
+                        out += lanes;
+                    } else {
+                        out = remove_scalar(first, first + lanes, out, value);
+                    }
+                }
+                return remove_scalar(first, last, out, value);
+            }
+
+            // Control characters are the bytes left unchanged by an unsigned min with 0x1f.
+            [[gnu::target("sse2")]] static auto find_json_escape(char const* first, char const* last) noexcept -> char const* {
+                const auto quote = _mm_set1_epi8('"'), backslash = _mm_set1_epi8('\\'), control = _mm_set1_epi8(0x1f);
+                for (; last - first >= static_cast<std::ptrdiff_t>(bytes); first += bytes) {
+                    const auto block   = _mm_loadu_si128(reinterpret_cast<vector const*>(first));
+                    const auto special = _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(block, quote), _mm_cmpeq_epi8(block, backslash)),
+                                                      _mm_cmpeq_epi8(_mm_min_epu8(block, control), block));
+                    if (const auto mask = static_cast<unsigned>(_mm_movemask_epi8(special))) {
+                        return first + std::countr_zero(mask);
+                    }
+                }
+                return find_json_escape_scalar(first, last);
+            }
+        };
+
+        struct avx2 {
+            using vector = __m256i;
+            static constexpr std::size_t bytes = 32;
+
+            template<class T>
+            static constexpr std::size_t stride = sizeof(T);
+
+            template<class T>
+            [[gnu::target("avx2")]] static auto broadcast(T value) noexcept -> vector {
+                if constexpr (std::is_same_v<T, float>)  return _mm256_castps_si256(_mm256_set1_ps(value));
+                else if constexpr (std::is_same_v<T, double>) return _mm256_castpd_si256(_mm256_set1_pd(value));
+                else if constexpr (sizeof(T) == 1) return _mm256_set1_epi8(static_cast<char>(bits(value)));
+                else if constexpr (sizeof(T) == 2) return _mm256_set1_epi16(static_cast<short>(bits(value)));
+                else if constexpr (sizeof(T) == 4) return _mm256_set1_epi32(static_cast<int>(bits(value)));
+                else return _mm256_set1_epi64x(static_cast<long long>(bits(value)));
+            }
+
+            template<class T>
+            [[gnu::target("avx2")]] static auto match(vector block, vector needle) noexcept -> std::uint64_t {
+                vector equal;
+                if constexpr (std::is_same_v<T, float>) {
+                    equal = _mm256_castps_si256(_mm256_cmp_ps(_mm256_castsi256_ps(block), _mm256_castsi256_ps(needle), _CMP_EQ_OQ));
+                } else if constexpr (std::is_same_v<T, double>) {
+                    equal = _mm256_castpd_si256(_mm256_cmp_pd(_mm256_castsi256_pd(block), _mm256_castsi256_pd(needle), _CMP_EQ_OQ));
+                } else if constexpr (sizeof(T) == 1) {
+                    equal = _mm256_cmpeq_epi8(block, needle);
+                } else if constexpr (sizeof(T) == 2) {
+                    equal = _mm256_cmpeq_epi16(block, needle);
+                } else if constexpr (sizeof(T) == 4) {
+                    equal = _mm256_cmpeq_epi32(block, needle);
+                } else {
+                    equal = _mm256_cmpeq_epi64(block, needle);
+                }
+                return static_cast<std::uint32_t>(_mm256_movemask_epi8(equal));
+            }
+
+            template<class T>
+            [[gnu::target("avx2")]] static auto find(T const* first, T const* last, T value) noexcept -> T const* {
+                constexpr std::size_t lanes = bytes / sizeof(T);
+                const auto needle = broadcast(value);
+                for (; static_cast<std::size_t>(last - first) >= lanes; first += lanes) {
+                    const auto block = _mm256_loadu_si256(reinterpret_cast<vector const*>(first));
+                    if (auto mask = match<T>(block, needle)) {
+                        return first + std::countr_zero(mask) / stride<T>;
+                    }
+                }
+                return std::find(first, last, value);
+            }
+
+            template<class T>
+            [[gnu::target("avx2")]] static auto remove(T const* first, T const* last, T* out, T value) noexcept -> T* {
+                constexpr std::size_t lanes = bytes / sizeof(T);
+                const auto needle = broadcast(value);
+                for (; static_cast<std::size_t>(last - first) >= lanes; first += lanes) {
+                    const auto block = _mm256_loadu_si256(reinterpret_cast<vector const*>(first));
+                    if (match<T>(block, needle) == 0) {
+                        _mm256_storeu_si256(reinterpret_cast<vector*>(out), block);
+                        out += lanes;
+                    } else {
+                        out = remove_scalar(first, first + lanes, out, value);
+                    }
+                }
+                return remove_scalar(first, last, out, value);
+            }
+
+            // Number of leading lanes of the sorted block at first less than the biased bound.
+            template<class T>
+            [[gnu::target("avx2")]] static auto count_less(T const* first, vector bound, vector bias) noexcept -> unsigned {
+                const auto block = _mm256_xor_si256(_mm256_loadu_si256(reinterpret_cast<vector const*>(first)), bias);
+                if constexpr (sizeof(T) == 4) {
+                    return static_cast<unsigned>(std::countr_one(static_cast<unsigned>(_mm256_movemask_ps(_mm256_castsi256_ps(_mm256_cmpgt_epi32(bound, block))))));
+                } else {
+                    return static_cast<unsigned>(std::countr_one(static_cast<unsigned>(_mm256_movemask_pd(_mm256_castsi256_pd(_mm256_cmpgt_epi64(bound, block))))));
+                }
+            }
+
+            // Runs of one element stay scalar, longer ones are skipped a block at a time by testing the
+            // block's last element, so the next address never waits on a vector compare. Only the block
+            // holding the answer is compared lane by lane. Compares are signed, unsigned lanes get their
+            // sign bit flipped first.
+            template<class T>
+            [[gnu::target("avx2")]] static auto skip_less(T* first, T* last, std::remove_const_t<T> value) noexcept -> T* {
+                using value_t = std::remove_const_t<T>;
+                constexpr std::size_t lanes = bytes / sizeof(T);
+                if (++first == last or not (*first < value)) {
+                    return first;
+                }
+                const auto bias  = broadcast(std::is_signed_v<value_t> ? value_t{ 0 } : static_cast<value_t>(value_t{ 1 } << (sizeof(T) * 8 - 1)));
+                const auto bound = _mm256_xor_si256(broadcast(value), bias);
+                for (; static_cast<std::size_t>(last - first) >= lanes; first += lanes) {
+                    if (not (first[lanes - 1] < value)) {
+                        return first + count_less(first, bound, bias);
+                    }
+                }
+                while (first != last and *first < value) {
+                    ++first;
+                }
+                return first;
+            }
+
+            template<class T, class U, class Operation>
+            [[gnu::target("avx2")]] static auto set_intersection(T* first1, T* last1, U const* first2, U const* last2, Operation& operation) noexcept -> void {
+                intersect(first1, last1, first2, last2, operation, [](auto* first, auto* last, auto value) { return skip_less(first, last, value); });
+            }
+
+            // Keys of the 64 byte node less than value, or not greater when Upper. The node is sorted,
+            // so the count is the popcount of the compare mask.
+            template<bool Upper, class T>
+            [[gnu::target("avx2")]] static auto node_rank(T const* node, T value) noexcept -> unsigned {
+                constexpr unsigned lanes = bytes / sizeof(T);
+                const auto bias  = broadcast(std::is_signed_v<T> ? T{ 0 } : static_cast<T>(T{ 1 } << (sizeof(T) * 8 - 1)));
+                const auto bound = _mm256_xor_si256(broadcast(value), bias);
+                const auto low   = _mm256_xor_si256(_mm256_loadu_si256(reinterpret_cast<vector const*>(node)), bias);
+                const auto high  = _mm256_xor_si256(_mm256_loadu_si256(reinterpret_cast<vector const*>(node + lanes)), bias);
+                if constexpr (Upper) {
+                    return 2 * lanes - static_cast<unsigned>(std::popcount(greater<T>(low, bound) | greater<T>(high, bound) << lanes));
+                } else {
+                    return static_cast<unsigned>(std::popcount(greater<T>(bound, low) | greater<T>(bound, high) << lanes));
+                }
+            }
+
+            // Bit i set when lane i of a is greater than lane i of b, signed.
+            template<class T>
+            [[gnu::target("avx2")]] static auto greater(vector a, vector b) noexcept -> unsigned {
+                if constexpr (sizeof(T) == 4) return static_cast<unsigned>(_mm256_movemask_ps(_mm256_castsi256_ps(_mm256_cmpgt_epi32(a, b))));
+                else                          return static_cast<unsigned>(_mm256_movemask_pd(_mm256_castsi256_pd(_mm256_cmpgt_epi64(a, b))));
+            }
+
+            [[gnu::target("avx2")]] static auto find_json_escape(char const* first, char const* last) noexcept -> char const* {
+                const auto quote = _mm256_set1_epi8('"'), backslash = _mm256_set1_epi8('\\'), control = _mm256_set1_epi8(0x1f);
+                for (; last - first >= static_cast<std::ptrdiff_t>(bytes); first += bytes) {
+                    const auto block   = _mm256_loadu_si256(reinterpret_cast<vector const*>(first));
+                    const auto special = _mm256_or_si256(_mm256_or_si256(_mm256_cmpeq_epi8(block, quote), _mm256_cmpeq_epi8(block, backslash)),
+                                                         _mm256_cmpeq_epi8(_mm256_min_epu8(block, control), block));
+                    if (const auto mask = static_cast<unsigned>(_mm256_movemask_epi8(special))) {
+                        return first + std::countr_zero(mask);
+                    }
+                }
+                return find_json_escape_scalar(first, last);
+            }
+        };
+
+        struct avx512 {
+            using vector = __m512i;
+            static constexpr std::size_t bytes = 64;
+
+            template<class T>
+            static constexpr std::size_t stride = 1;
+
+            template<class T>
+            [[gnu::target("avx512f,avx512bw")]] static auto broadcast(T value) noexcept -> vector {
+                if constexpr (std::is_same_v<T, float>)  return _mm512_castps_si512(_mm512_set1_ps(value));
+                else if constexpr (std::is_same_v<T, double>) return _mm512_castpd_si512(_mm512_set1_pd(value));
+                else if constexpr (sizeof(T) == 1) return _mm512_set1_epi8(static_cast<char>(bits(value)));
+                else if constexpr (sizeof(T) == 2) return _mm512_set1_epi16(static_cast<short>(bits(value)));
+                else if constexpr (sizeof(T) == 4) return _mm512_set1_epi32(static_cast<int>(bits(value)));
+                else return _mm512_set1_epi64(static_cast<long long>(bits(value)));
+            }
+
+            template<class T>
+            [[gnu::target("avx512f,avx512bw")]] static auto match(vector block, vector needle) noexcept -> std::uint64_t {
+                if constexpr (std::is_same_v<T, float>) {
+                    return _mm512_cmp_ps_mask(_mm512_castsi512_ps(block), _mm512_castsi512_ps(needle), _CMP_EQ_OQ);
+                } else if constexpr (std::is_same_v<T, double>) {
+                    return _mm512_cmp_pd_mask(_mm512_castsi512_pd(block), _mm512_castsi512_pd(needle), _CMP_EQ_OQ);
+                } else if constexpr (sizeof(T) == 1) {
+                    return _mm512_cmpeq_epi8_mask(block, needle);
+                } else if constexpr (sizeof(T) == 2) {
+                    return _mm512_cmpeq_epi16_mask(block, needle);
+                } else if constexpr (sizeof(T) == 4) {
+                    return _mm512_cmpeq_epi32_mask(block, needle);
+                } else {
+                    return _mm512_cmpeq_epi64_mask(block, needle);
+                }
+            }
+
+            template<class T>
+            [[gnu::target("avx512f,avx512bw")]] static auto find(T const* first, T const* last, T value) noexcept -> T const* {
+                constexpr std::size_t lanes = bytes / sizeof(T);
+                const auto needle = broadcast(value);
+                for (; static_cast<std::size_t>(last - first) >= lanes; first += lanes) {
+                    const auto block = _mm512_loadu_si512(first);
+                    if (auto mask = match<T>(block, needle)) {
+                        return first + std::countr_zero(mask);
+                    }
+                }
+                return std::find(first, last, value);
+            }
+
+            // 32 and 64 bit lanes are compressed in registers, narrower ones take the scalar path on a match.
+            template<class T>
+            [[gnu::target("avx512f,avx512bw")]] static auto remove(T const* first, T const* last, T* out, T value) noexcept -> T* {
+                constexpr std::size_t lanes = bytes / sizeof(T);
+                const auto needle = broadcast(value);
+                for (; static_cast<std::size_t>(last - first) >= lanes; first += lanes) {
+                    const auto block = _mm512_loadu_si512(first);
+                    const auto mask  = match<T>(block, needle);
+                    if (mask == 0) {
+                        _mm512_storeu_si512(out, block);
+                        out += lanes;
+                    } else if constexpr (sizeof(T) == 4) {
+                        const auto keep = static_cast<__mmask16>(~mask);
+                        _mm512_storeu_si512(out, _mm512_maskz_compress_epi32(keep, block));
+                        out += std::popcount(static_cast<std::uint16_t>(keep));
+                    } else if constexpr (sizeof(T) == 8) {
+                        const auto keep = static_cast<__mmask8>(~mask);
+                        _mm512_storeu_si512(out, _mm512_maskz_compress_epi64(keep, block));
+                        out += std::popcount(static_cast<std::uint8_t>(keep));
+                    } else {
+                        out = remove_scalar(first, first + lanes, out, value);
+                    }
+                }
+                return remove_scalar(first, last, out, value);
+            }
+
+            template<class T>
+            [[gnu::target("avx512f,avx512bw")]] static auto skip_less(T* first, T* last, std::remove_const_t<T> value) noexcept -> T* {
+                using value_t = std::remove_const_t<T>;
+                constexpr std::size_t lanes = bytes / sizeof(T);
+                if (++first == last or not (*first < value)) {
+                    return first;
+                }
+                const auto bound = broadcast(value);
+                for (; static_cast<std::size_t>(last - first) >= lanes; first += lanes) {
+                    if (first[lanes - 1] < value) {
+                        continue;
+                    }
+                    const auto block = _mm512_loadu_si512(first);
+                    std::uint64_t mask;
+                    if constexpr (sizeof(T) == 4 and std::is_signed_v<value_t>) mask = _mm512_cmplt_epi32_mask(block, bound);
+                    else if constexpr (sizeof(T) == 4)                          mask = _mm512_cmplt_epu32_mask(block, bound);
+                    else if constexpr (std::is_signed_v<value_t>)               mask = _mm512_cmplt_epi64_mask(block, bound);
+                    else                                                        mask = _mm512_cmplt_epu64_mask(block, bound);
+                    return first + std::countr_one(mask);
+                }
+                while (first != last and *first < value) {
+                    ++first;
+                }
+                return first;
+            }
+
+            template<class T, class U, class Operation>
+            [[gnu::target("avx512f,avx512bw")]] static auto set_intersection(T* first1, T* last1, U const* first2, U const* last2, Operation& operation) noexcept -> void {
+                intersect(first1, last1, first2, last2, operation, [](auto* first, auto* last, auto value) { return skip_less(first, last, value); });
+            }
+
+            template<bool Upper, class T>
+            [[gnu::target("avx512f,avx512bw")]] static auto node_rank(T const* node, T value) noexcept -> unsigned {
+                const auto block = _mm512_loadu_si512(node);
+                const auto bound = broadcast(value);
+                constexpr int predicate = Upper ? _MM_CMPINT_LE : _MM_CMPINT_LT;
+                std::uint64_t mask;
+                if constexpr (sizeof(T) == 4 and std::is_signed_v<T>) mask = _mm512_cmp_epi32_mask(block, bound, predicate);
+                else if constexpr (sizeof(T) == 4)                   mask = _mm512_cmp_epu32_mask(block, bound, predicate);
+                else if constexpr (std::is_signed_v<T>)              mask = _mm512_cmp_epi64_mask(block, bound, predicate);
+                else                                                 mask = _mm512_cmp_epu64_mask(block, bound, predicate);
+                return static_cast<unsigned>(std::popcount(mask));
+            }
+
+            [[gnu::target("avx512f,avx512bw")]] static auto find_json_escape(char const* first, char const* last) noexcept -> char const* {
+                const auto quote = _mm512_set1_epi8('"'), backslash = _mm512_set1_epi8('\\'), control = _mm512_set1_epi8(0x20);
+                for (; last - first >= static_cast<std::ptrdiff_t>(bytes); first += bytes) {
+                    const auto block = _mm512_loadu_si512(first);
+                    const auto mask  = _mm512_cmpeq_epi8_mask(block, quote) | _mm512_cmpeq_epi8_mask(block, backslash) |
+                                       _mm512_cmplt_epu8_mask(block, control);
+                    if (mask != 0) {
+                        return first + std::countr_zero(mask);
+                    }
+                }
+                return find_json_escape_scalar(first, last);
+            }
+        };
+
+#endif
+    }
+
+    /**
+     * @brief First element of [ @p first , @p last ) equal to @p value , or @p last .
+     *
+     * @param use instruction set to run on, the detected one by default.
+     * Asking for more than the CPU supports is undefined behaviour.
+     */
+    template<class T>
+    auto find(T const* first, T const* last, T value, isa use = detected_isa()) noexcept -> T const* {
+        static_assert(is_vectorizable<T>, "Only integers, enums, pointers, floats and doubles are vectorized.");
+#if CALGO_SIMD_X86
+        switch (use) {
+            case isa::avx512: return detail::avx512::find(first, last, value);
+            case isa::avx2:   return detail::avx2::find(first, last, value);
+            case isa::sse2:   return detail::sse2::find(first, last, value);
+            case isa::scalar: break;
+        }
+#endif
+        return std::find(first, last, value);
+    }
+
+    /**
+     * @brief Moves the elements of [ @p first , @p last ) not equal to @p value to the front,
+     * keeping their order, like std::remove.
+     *
+     * @param use instruction set to run on, the detected one by default.
+     * @return end of the kept elements.
+     */
+    template<class T>
+    auto remove(T* first, T* last, T value, isa use = detected_isa()) noexcept -> T* {
+        static_assert(is_vectorizable<T>, "Only integers, enums, pointers, floats and doubles are vectorized.");
+        // Nothing moves before the first match.
+        first = const_cast<T*>(simd::find(static_cast<T const*>(first), static_cast<T const*>(last), value, use));
+        if (first == last) {
+            return last;
+        }
+#if CALGO_SIMD_X86
+        switch (use) {
+            case isa::avx512: return detail::avx512::remove(first + 1, last, first, value);
+            case isa::avx2:   return detail::avx2::remove(first + 1, last, first, value);
+            case isa::sse2:   return detail::sse2::remove(first + 1, last, first, value);
+            case isa::scalar: break;
+        }
+#endif
+        return detail::remove_scalar(first + 1, last, first, value);
+    }
+
+    /**
+     * @brief Calls @p operation on every element of the sorted [ @p first1 , @p last1 ) also in the
+     * sorted [ @p first2 , @p last2 ), with the output of std::set_intersection, duplicates included.
+     *
+     * A merge whose runs of smaller elements are skipped a whole block compare at a time,
+     * for ranges of similar size that interleave in runs of a few elements or more.
+     *
+     * @param use instruction set to run on, the detected one by default.
+     */
+    template<class T, class Operation>
+    auto set_intersection(T* first1, T* last1, std::remove_const_t<T> const* first2, std::remove_const_t<T> const* last2,
+                          Operation operation, isa use = detected_isa()) noexcept -> void {
+        static_assert(is_vectorizable_ordered<std::remove_const_t<T>>, "Only 32 and 64 bit integers are vectorized.");
+#if CALGO_SIMD_X86
+        switch (use) {
+            case isa::avx512: detail::avx512::set_intersection(first1, last1, first2, last2, operation); return;
+            case isa::avx2:   detail::avx2::set_intersection(first1, last1, first2, last2, operation);   return;
+            case isa::sse2:   break;
+            case isa::scalar: break;
+        }
+#endif
+        detail::intersect(first1, last1, first2, last2, operation, [](auto* first, auto*, auto) { return first + 1; });
+    }
+
+    /**
+     * @brief Searches up to 16 @p values at once in an implicit B+ tree of @p height layers.
+     *
+     * Layer h starts at tree + layers[h], the top first, layers[height] is the end of the tree.
+     * Nodes hold btree_node_keys<T> sorted keys, 64 bytes, node k of a layer has the children
+     * k * (keys + 1) to k * (keys + 1) + keys in the next one, whose smallest keys it holds but the first's.
+     * The last layer holds all the keys in order: positions[j] gets the position there of the first
+     * key not less than values[j], greater than with Upper, possibly past the padded end.
+     *
+     * @param use instruction set to run on, the detected one by default.
+     */
+    template<bool Upper, class T>
+    auto btree_search(T const* tree, std::size_t const* layers, std::size_t height, T const* values, std::size_t count,
+                      std::size_t* positions, isa use = detected_isa()) noexcept -> void {
+        static_assert(is_vectorizable_ordered<T>, "Only 32 and 64 bit integers are vectorized.");
+        constexpr auto keys = detail::btree_node_keys<T>;
+#if CALGO_SIMD_X86
+        switch (use) {
+            case isa::avx512:
+                detail::btree_search<keys>(tree, layers, height, values, count, positions, [](T const* node, T value) { return detail::avx512::node_rank<Upper>(node, value); });
+                return;
+            case isa::avx2:
+                detail::btree_search<keys>(tree, layers, height, values, count, positions, [](T const* node, T value) { return detail::avx2::node_rank<Upper>(node, value); });
+                return;
+            case isa::sse2:   break;
+            case isa::scalar: break;
+        }
+#endif
+        detail::btree_search<keys>(tree, layers, height, values, count, positions, [](T const* node, T value) {
+            unsigned rank = 0;
+            for (std::size_t i = 0; i != keys; ++i) {
+                rank += Upper ? not (value < node[i]) : node[i] < value;
+            }
+            return rank;
+        });
+    }
+
+    /**
+     * @brief First char of [ @p first , @p last ) a JSON string has to escape, a quote, a backslash
+     * or a control character, or @p last .
+     *
+     * @param use instruction set to run on, the detected one by default.
+     */
+    inline auto find_json_escape(char const* first, char const* last, isa use = detected_isa()) noexcept -> char const* {
+#if CALGO_SIMD_X86
+        switch (use) {
+            case isa::avx512: return detail::avx512::find_json_escape(first, last);
+            case isa::avx2:   return detail::avx2::find_json_escape(first, last);
+            case isa::sse2:   return detail::sse2::find_json_escape(first, last);
+            case isa::scalar: break;
+        }
+#endif
+        return detail::find_json_escape_scalar(first, last);
+    }
+}
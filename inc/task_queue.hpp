@@ -1,3 +1,4 @@
+#pragma once
 
 /// *** Task Stealing Queue C++11 ***
 #include <atomic>
@@ -6,6 +7,8 @@
 #include <thread>
 #include <mutex>
 #include <condition_variable>
+#include <functional>
+#include <latch>
 
 /// *** Common type vocabulary *** //
 using function_signiture_t = void();
@@ -83,8 +86,12 @@ public:
 
 	template<class Function>
 	void push(Function&& func) noexcept {
-		lock_t lock{ mutex };
-		queue.emplace_back(std::forward<Function>(func));
+		{
+			lock_t lock{ mutex };
+			queue.emplace_back(std::forward<Function>(func));
+		}
+
+		ready.notify_one();
 	}
 
 	void done() noexcept {
@@ -175,4 +182,34 @@ public:
 		}
 		notifications[i % count].push(std::forward<Function>(work));
 	}
+
+	/// @brief Number of worker threads in the pool.
+	///
+	unsigned concurrency() const noexcept { return count; }
+
+	/// @brief Runs @p work(n) for every n in [0, parts) on the pool and
+	/// blocks until all of them have finished. The calling thread runs the
+	/// last part itself instead of idling while it waits.
+	///
+	/// Must not be called from inside a task running on this same pool,
+	/// the waiting worker could starve the parts it is waiting on.
+	///
+	/// @tparam Function Any callable taking the part index as an unsigned.
+	/// @param parts number of parts the work is split into.
+	/// @param work function ran once per part.
+	///
+	template<class Function>
+	void fork_join(unsigned parts, Function work) noexcept {
+		if (parts == 0) {
+			return;
+		}
+
+		std::latch done{ static_cast<std::ptrdiff_t>(parts - 1) };
+		for (unsigned n = 0; n + 1 < parts; ++n) {
+			async([&work, &done, n] { work(n); done.count_down(); });
+		}
+
+		work(parts - 1);
+		done.wait();
+	}
 };
@@ -8,11 +8,25 @@
 #include <iostream>
 #include <string_view>
 #include <limits>
+#include <cstdio>
+#include <filesystem>
+#include <map>
+#include <string>
 
 #include "task_queue.hpp"
 #include "prettyprint.hpp"
+#include "prettyprint_async.hpp"
+#include "prettyprint_binary.hpp"
+#include "prettyprint_buffer.hpp"
+#include "prettyprint_json.hpp"
 #include "associated_collection.hpp"
+#include "associated_algorithms.hpp"
+#include "associated_snapshot.hpp"
 #include "container_algo.hpp"
+#include "hash_algo.hpp"
+#include "multiway_algo.hpp"
+#include "parallel_algo.hpp"
+#include "search_index.hpp"
 
 using dog_key = std::tuple<int, float>;
 struct dog {
@@ -32,6 +46,12 @@ struct cat {
 	bool operator<(cat const& e)      const { return key < e.key; }
 };
 
+// dog and cat only wrap a tuple of numbers, so calgo may memcpy them as it does the tuple.
+namespace calgo {
+	template<> constexpr bool is_memcpy_copyable<dog> = is_memcpy_copyable<dog_key>;
+	template<> constexpr bool is_memcpy_copyable<cat> = is_memcpy_copyable<cat_key>;
+}
+
 std::ostream& operator<< (std::ostream& os, dog const& t) {
 	os << t.key;
 	return os;
@@ -67,6 +87,12 @@ auto main() -> int
 	std::cout << "dogs:\n\t" << dogs << "\n\t" << dogs.associations() << "\n";
 	std::cout << "cats:\n\t" << cats << "\n\t" << cats.associations() << "\n";
 
+	std::cout << "\ndogs by degree :";
+	dogs.visit_by_degree([](auto& key, auto degree){
+		std::cout << " " << key << " x" << degree;
+	});
+	std::cout << "\n";
+
 	std::cout << "\nvisiting all the dogs that are associated with cat " << ck3 << " : ";
 	dogs.visit(ck3, [&](auto& doggo){
 		std::cout << "\n\t " << doggo << " : ";
@@ -76,22 +102,123 @@ auto main() -> int
 	});
 	std::cout << "\n";
 
+	std::vector<cat_key> wanted{ ck3, ck, ck3 };
+	std::cout << "\nvisiting all the dogs that are associated with cats " << wanted << " : ";
+	dogs.visit_many(wanted, [](auto& cat_key, auto& doggo){
+		std::cout << "\n\t " << doggo << " : " << cat_key;
+	});
+	std::cout << "\n";
+
+	task_system tasks;
+	std::atomic<int> visited{ 0 };
+	dogs.visit_many(wanted, [&](auto&, auto&){ ++visited; }, tasks);
+	std::cout << "\nvisited in parallel: " << visited << "\n";
+
+	std::cout << "\njoining dogs with cats, " << join_count(dogs, cats) << " pairs : ";
+	join(dogs, cats, [](auto& doggo, auto& cat){
+		std::cout << "\n\t " << doggo << " : " << cat;
+	});
+	std::cout << "\n";
+
+	const std::vector<dog_key> from{ dk };
+	for (std::size_t depth = 1; depth <= 3; ++depth) {
+		auto reached = reachable(dogs, cats, from, depth, tasks);
+		std::cout << "\nreachable from dog " << dk << " in " << depth << " hops: " << reached.first << " " << reached.second;
+	}
+	std::cout << "\n";
+
 	std::cout << "\n";
 
 	auto kd = ck;
-	auto& k = cats.erase(kd);
+	decltype(cats)::foreign_collection_type k;
+	decltype(dogs)::foreign_collection_type ks;
+	cats.erase(kd, k);
 	std::cout << "\nerased in cats: " << kd << "\n\tneed to remove in dogs " << k << "\n";
-	auto& ks = dogs.erase(k);
+	dogs.erase(k, ks);
 	std::cout << "\nerased in dogs: " << k << "\n\tneed to remove in cats " << ks << "\n";
 	k.clear();
-	k = cats.erase(ks);
+	cats.erase(ks, k);
 	std::cout << "\nerased in cats: " << ks << "\n\tneed to remove in dogs " << k << "\n";
-	ks.clear();
 
 	std::cout << "dogs:\n\t" << dogs << "\n\t" << dogs.associations() << "\n";
 	std::cout << "cats:\n\t" << cats << "\n\t" << cats.associations() << "\n";
-	
 
-	
+	dogs.compact();
+	cats.compact();
+	std::cout << "\nbytes held after compacting, dogs: " << dogs.memory_usage().total_bytes()
+	          << " cats: " << cats.memory_usage().total_bytes() << "\n";
+
+	const auto snapshot_path = (std::filesystem::temp_directory_path() / "simple_dogs.snapshot").string();
+	if (write_snapshot(dogs, snapshot_path.c_str())) {
+		auto snapshot = associated_snapshot<decltype(dogs)>::open(snapshot_path.c_str());
+		auto promoted = snapshot->to_collection();
+		std::cout << "\nsnapshot of dogs: " << promoted << " " << promoted.associations()
+		          << "\n\tsame as dogs: " << (std::ranges::equal(snapshot->collection(), dogs) and
+		                                     std::ranges::equal(snapshot->associations(), dogs.associations())) << "\n";
+		std::filesystem::remove(snapshot_path);
+	}
+
+	std::vector<int> sorted(1000);
+	for (int i = 0; i < 1000; ++i) sorted[i] = i / 2 * 3;
+	calgo::search_index index(sorted);
+	bool same_bounds = true;
+	for (int probe = -1; probe <= 1500; ++probe) {
+		same_bounds &= index.lower_bound(probe) == static_cast<std::size_t>(std::lower_bound(std::begin(sorted), std::end(sorted), probe) - std::begin(sorted));
+	}
+	std::cout << "\nsearch_index lower_bound same as std::lower_bound: " << same_bounds << "\n";
+
+	std::vector<int> shuffled(10000);
+	for (int i = 0; i < 10000; ++i) shuffled[i] = (i * 7919) % 10007;
+	auto parallel_sorted = shuffled, std_sorted = shuffled;
+	calgo::sort(tasks, parallel_sorted);
+	std::sort(std::begin(std_sorted), std::end(std_sorted));
+	const auto found = calgo::find_if(tasks, shuffled, [](int x) { return x > 10000; });
+	std::cout << "parallel sort same as std::sort: " << (parallel_sorted == std_sorted)
+	          << ", parallel find_if same as std::find_if: " << (found == std::find_if(std::begin(shuffled), std::end(shuffled), [](int x) { return x > 10000; })) << "\n";
+
+	std::vector<int> repeated{ 5, 3, 5, 1, 3, 8, 1 }, others{ 8, 2, 3, 9 }, in_both;
+	calgo::set_intersection_unordered(repeated, others, std::back_inserter(in_both));
+	calgo::erase_duplicates_unordered(repeated);
+	std::cout << "unordered dedup " << repeated << ", intersection with " << others << " " << in_both << "\n";
+
+	const std::vector<std::vector<int>> runs{ { 1, 4, 7, 9 }, { 2, 4, 8 }, { 0, 4, 9, 10 } };
+	std::vector<int> merged, std_merged;
+	calgo::multiway_merge(runs, [&](int x) { merged.push_back(x); });
+	for (auto const& run : runs) {
+		std::vector<int> next;
+		std::merge(std::begin(std_merged), std::end(std_merged), std::begin(run), std::end(run), std::back_inserter(next));
+		std_merged.swap(next);
+	}
+	std::vector<int> common;
+	calgo::multiway_set_intersection(runs, [&](int x) { common.push_back(x); });
+	std::cout << "multiway merge " << merged << " same as std::merge: " << (merged == std_merged) << ", intersection " << common << "\n";
+
+	std::cout << "\nprinted through a format_buffer: ";
+	std::fflush(stdout);
+	pretty_print::fprint(stdout, dogs.associations());
+	std::cout << "\n";
+	std::cout << "bounded to 3 elements: " << pretty_print::bounded(std_sorted, { .max_elements = 3 }) << "\n";
+
+	pretty_print::format_buffer bytes;
+	pretty_print::serialize(bytes, dogs.associations());
+	const auto read_back = pretty_print::deserialize<decltype(dogs)::association_type>(bytes.view());
+	std::cout << "binary associations, " << bytes.size() << " bytes, read back the same: " << (read_back and *read_back == dogs.associations()) << "\n";
+
+	const std::map<std::string, std::vector<double>> weights{ { "dogs", { 1.5, 2 } }, { "cats \"p\"", {} } };
+	const std::multimap<std::string, int> litters{ { "a", 1 }, { "a", 2 } };
+	std::cout << "json: ";
+	std::fflush(stdout);
+	pretty_print::fprint_json(stdout, weights);
+	std::cout << " ";
+	std::fflush(stdout);
+	pretty_print::fprint_json(stdout, litters);
+	std::cout << "\n";
+
+	std::fflush(stdout);
+	{
+		pretty_print::async_log_sink sink(tasks, stdout, 1 << 12, { .max_elements = 4 });
+		sink.log("logged from a worker: ", std_sorted);
+	}
+
 	return 0;
 }